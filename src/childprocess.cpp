@@ -0,0 +1,106 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "childprocess.h"
+
+#include <QTextCodec>
+
+ChildProcess::ChildProcess(QObject *parent)
+    : REPLCompletable(parent)
+    , m_process(this)
+    , m_stdoutDecoder(QTextCodec::codecForName("UTF-8")->makeDecoder())
+    , m_stderrDecoder(QTextCodec::codecForName("UTF-8")->makeDecoder())
+{
+    setObjectName("ChildProcess");
+
+    connect(&m_process, SIGNAL(readyReadStandardOutput()), SLOT(readStdout()));
+    connect(&m_process, SIGNAL(readyReadStandardError()), SLOT(readStderr()));
+    connect(&m_process, SIGNAL(finished(int, QProcess::ExitStatus)), SLOT(handleFinished(int, QProcess::ExitStatus)));
+}
+
+ChildProcess::~ChildProcess()
+{
+    if (m_process.state() != QProcess::NotRunning) {
+        m_process.kill();
+        m_process.waitForFinished();
+    }
+    delete m_stdoutDecoder;
+    delete m_stderrDecoder;
+}
+
+qint64 ChildProcess::pid() const
+{
+#ifdef Q_OS_WIN32
+    const Q_PID pid = m_process.pid();
+    return pid ? pid->dwProcessId : 0;
+#else
+    return m_process.pid();
+#endif
+}
+
+bool ChildProcess::start(const QString &command, const QStringList &args)
+{
+    if (m_process.state() != QProcess::NotRunning)
+        return false;
+
+    m_process.start(command, args);
+    return m_process.waitForStarted();
+}
+
+void ChildProcess::kill()
+{
+    m_process.kill();
+}
+
+void ChildProcess::readStdout()
+{
+    const QString data = m_stdoutDecoder->toUnicode(m_process.readAllStandardOutput());
+    if (!data.isEmpty())
+        emit stdoutData(data);
+}
+
+void ChildProcess::readStderr()
+{
+    const QString data = m_stderrDecoder->toUnicode(m_process.readAllStandardError());
+    if (!data.isEmpty())
+        emit stderrData(data);
+}
+
+void ChildProcess::handleFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // Deliver what is left of the output first
+    readStdout();
+    readStderr();
+    emit exit(exitStatus == QProcess::NormalExit ? exitCode : -1);
+}
+
+void ChildProcess::initCompletions()
+{
+    addCompletion("pid");
+    addCompletion("start");
+    addCompletion("kill");
+}
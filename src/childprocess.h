@@ -0,0 +1,83 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CHILDPROCESS_H
+#define CHILDPROCESS_H
+
+#include <QProcess>
+#include <QStringList>
+#include <QTextDecoder>
+
+#include "replcompletable.h"
+
+/**
+ * A process started by the script, with its output delivered as signals.
+ *
+ * see also: modules/child_process.js
+ */
+class ChildProcess : public REPLCompletable
+{
+    Q_OBJECT
+    Q_PROPERTY(qint64 pid READ pid)
+
+public:
+    ChildProcess(QObject *parent);
+    virtual ~ChildProcess();
+
+    qint64 pid() const;
+
+public slots:
+    /**
+     * Start "command" with the given arguments, in the current working directory.
+     * @return "false" if the process could not be started
+     */
+    bool start(const QString &command, const QStringList &args);
+    void kill();
+
+signals:
+    void stdoutData(const QString &data);
+    void stderrData(const QString &data);
+    /**
+     * Emitted once the process is gone; "code" is -1 if it crashed or was killed.
+     */
+    void exit(int code);
+
+private slots:
+    void readStdout();
+    void readStderr();
+    void handleFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    virtual void initCompletions();
+
+    QProcess m_process;
+    // UTF-8 characters may be split between two reads
+    QTextDecoder *m_stdoutDecoder;
+    QTextDecoder *m_stderrDecoder;
+};
+
+#endif // CHILDPROCESS_H
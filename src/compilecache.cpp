@@ -0,0 +1,108 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "compilecache.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+#include "phantom.h"
+#include "config.h"
+
+static CompileCache *compilecache_instance = 0;
+
+CompileCache *CompileCache::instance()
+{
+    if (!compilecache_instance)
+        compilecache_instance = new CompileCache();
+
+    return compilecache_instance;
+}
+
+CompileCache::CompileCache()
+    : QObject(QCoreApplication::instance())
+    , m_enabled(false)
+{
+    const QString path = Phantom::instance()->config()->compileCachePath();
+    if (!path.isEmpty()) {
+        m_dir.setPath(path);
+        m_enabled = m_dir.mkpath(".");
+    }
+}
+
+bool CompileCache::isEnabled() const
+{
+    return m_enabled;
+}
+
+QString CompileCache::find(const QString &compiler, const QString &source) const
+{
+    if (!m_enabled)
+        return QString();
+
+    QFile file(fileName(compiler, source));
+    if (!file.open(QFile::ReadOnly))
+        return QString();
+
+    return QString::fromUtf8(file.readAll());
+}
+
+void CompileCache::insert(const QString &compiler, const QString &source, const QString &output)
+{
+    if (!m_enabled)
+        return;
+
+    const QString name = fileName(compiler, source);
+    m_dir.mkpath(QFileInfo(name).path());
+
+    // Write aside and rename, so concurrent processes never read half an entry
+    const QString temporaryName = QString("%1.%2").arg(name).arg(QCoreApplication::applicationPid());
+    QFile file(temporaryName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        return;
+    const QByteArray data = output.toUtf8();
+    const bool written = file.write(data) == data.size();
+    file.close();
+
+    QFile::remove(name);
+    if (!written || !QFile::rename(temporaryName, name))
+        QFile::remove(temporaryName);
+}
+
+QString CompileCache::fileName(const QString &compiler, const QString &source) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(compiler.toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(source.toUtf8());
+    const QString key = hash.result().toHex();
+
+    // Spread the entries like Git objects, to keep directories small
+    return m_dir.filePath(key.left(2) + '/' + key.mid(2) + ".js");
+}
@@ -0,0 +1,60 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef COMPILECACHE_H
+#define COMPILECACHE_H
+
+#include <QObject>
+#include <QDir>
+
+/**
+ * On-disk cache of compiler output (e.g. CoffeeScript to JavaScript).
+ *
+ * Entries are keyed by a SHA-1 hash of the compiler identity and of the
+ * source, so an unchanged source is never compiled twice, whatever file it
+ * comes from. The cache is enabled with '--compile-cache-path'.
+ */
+class CompileCache: public QObject
+{
+public:
+    static CompileCache *instance();
+
+    bool isEnabled() const;
+
+    /// @return the output cached for @p source, or a null string
+    QString find(const QString &compiler, const QString &source) const;
+    void insert(const QString &compiler, const QString &source, const QString &output);
+
+private:
+    CompileCache();
+    QString fileName(const QString &compiler, const QString &source) const;
+
+    QDir m_dir;
+    bool m_enabled;
+};
+
+#endif // COMPILECACHE_H
@@ -32,8 +32,7 @@
 #include "config.h"
 
 #include <QDir>
-#include <QWebPage>
-#include <QWebFrame>
+#include <QMetaObject>
 #include <QNetworkProxy>
 #include <QtNetwork/QSslConfiguration>
 #include <QtNetwork/QSslSocket>
@@ -41,10 +40,304 @@
 
 #include "terminal.h"
 #include "qcommandline.h"
-#include "utils.h"
 
 #include <iostream>
 
+namespace JsonParser {
+
+// Reader for the JSON (RFC 4627) '--config' file, into QVariant
+class Reader
+{
+public:
+    Reader(const QString &json)
+        : m_json(json)
+        , m_pos(0)
+        , m_failed(false)
+    {
+    }
+
+    QVariant parse()
+    {
+        QVariant result = value();
+        skipSpaces();
+        if (!m_failed && m_pos != m_json.length()) {
+            return fail();
+        }
+        return result;
+    }
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+    QString error() const
+    {
+        return m_error;
+    }
+
+private:
+    // Fails at the current position, only the first error is kept
+    QVariant fail(const QString &reason = QString())
+    {
+        if (m_failed) {
+            return QVariant();
+        }
+        m_failed = true;
+
+        QString what = reason;
+        if (what.isEmpty()) {
+            what = m_pos < m_json.length()
+                    ? QString("Unexpected character '%1'").arg(m_json.at(m_pos))
+                    : QString("Unexpected end of input");
+        }
+        const int line = m_json.left(m_pos).count('\n') + 1;
+        const int column = m_pos - (m_pos > 0 ? m_json.lastIndexOf('\n', m_pos - 1) : -1);
+        m_error = QString("%1 at line %2, column %3").arg(what).arg(line).arg(column);
+        return QVariant();
+    }
+
+    bool at(char c) const
+    {
+        return m_pos < m_json.length() && m_json.at(m_pos) == QLatin1Char(c);
+    }
+
+    bool atDigit() const
+    {
+        return m_pos < m_json.length() && m_json.at(m_pos) >= '0' && m_json.at(m_pos) <= '9';
+    }
+
+    void skipSpaces()
+    {
+        // only the white space of the JSON grammar
+        while (at(' ') || at('\t') || at('\n') || at('\r')) {
+            ++m_pos;
+        }
+    }
+
+    QVariant value()
+    {
+        skipSpaces();
+        if (m_pos >= m_json.length()) {
+            return fail();
+        }
+
+        const QChar c = m_json.at(m_pos);
+        if (c == '{') {
+            return object();
+        } else if (c == '[') {
+            return array();
+        } else if (c == '"') {
+            return string();
+        } else if (c == 't') {
+            return literal("true", true);
+        } else if (c == 'f') {
+            return literal("false", false);
+        } else if (c == 'n') {
+            return literal("null", QVariant());
+        } else if (c == '-' || atDigit()) {
+            return number();
+        }
+        return fail();
+    }
+
+    QVariant object()
+    {
+        QVariantMap result;
+        ++m_pos; // '{'
+        skipSpaces();
+        if (at('}')) {
+            ++m_pos;
+            return result;
+        }
+
+        while (!m_failed) {
+            skipSpaces();
+            if (!at('"')) {
+                return fail();
+            }
+            const QString key = string().toString();
+            skipSpaces();
+            if (!at(':')) {
+                return fail();
+            }
+            ++m_pos;
+            result.insert(key, value());
+            skipSpaces();
+            if (at(',')) {
+                ++m_pos;
+            } else if (at('}')) {
+                ++m_pos;
+                return result;
+            } else {
+                return fail();
+            }
+        }
+        return QVariant();
+    }
+
+    QVariant array()
+    {
+        QVariantList result;
+        ++m_pos; // '['
+        skipSpaces();
+        if (at(']')) {
+            ++m_pos;
+            return result;
+        }
+
+        while (!m_failed) {
+            result.append(value());
+            skipSpaces();
+            if (at(',')) {
+                ++m_pos;
+            } else if (at(']')) {
+                ++m_pos;
+                return result;
+            } else {
+                return fail();
+            }
+        }
+        return QVariant();
+    }
+
+    QVariant string()
+    {
+        QString result;
+        ++m_pos; // '"'
+        while (m_pos < m_json.length()) {
+            const QChar c = m_json.at(m_pos);
+            if (c == '"') {
+                ++m_pos;
+                return result;
+            }
+            if (c.unicode() < 0x20) {
+                return fail("Control character in string");
+            }
+            ++m_pos;
+            if (c != '\\') {
+                result.append(c);
+                continue;
+            }
+            if (m_pos >= m_json.length()) {
+                return fail();
+            }
+            const char escape = m_json.at(m_pos).toLatin1();
+            switch (escape) {
+            case '"': result.append('"'); break;
+            case '\\': result.append('\\'); break;
+            case '/': result.append('/'); break;
+            case 'b': result.append('\b'); break;
+            case 'f': result.append('\f'); break;
+            case 'n': result.append('\n'); break;
+            case 'r': result.append('\r'); break;
+            case 't': result.append('\t'); break;
+            case 'u': {
+                // exactly four hex digits, surrogate pairs come as two escapes
+                const QString hex = m_json.mid(m_pos + 1, 4);
+                ushort code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = i < hex.length() ? QString("0123456789abcdef").indexOf(hex.at(i).toLower()) : -1;
+                    if (digit < 0) {
+                        return fail("Invalid \\u escape");
+                    }
+                    code = code * 16 + digit;
+                }
+                result.append(QChar(code));
+                m_pos += 4;
+                break;
+            }
+            default:
+                return fail("Invalid escape");
+            }
+            ++m_pos;
+        }
+        return fail();
+    }
+
+    // -? (0 | [1-9][0-9]*) (\.[0-9]+)? ([eE][+-]?[0-9]+)?
+    QVariant number()
+    {
+        const int start = m_pos;
+        bool integer = true;
+        if (at('-')) {
+            ++m_pos;
+        }
+        if (at('0')) {
+            ++m_pos;
+        } else if (atDigit()) {
+            while (atDigit()) {
+                ++m_pos;
+            }
+        } else {
+            return fail("Invalid number");
+        }
+        if (at('.')) {
+            integer = false;
+            ++m_pos;
+            if (!atDigit()) {
+                return fail("Invalid number");
+            }
+            while (atDigit()) {
+                ++m_pos;
+            }
+        }
+        if (at('e') || at('E')) {
+            integer = false;
+            ++m_pos;
+            if (at('+') || at('-')) {
+                ++m_pos;
+            }
+            if (!atDigit()) {
+                return fail("Invalid number");
+            }
+            while (atDigit()) {
+                ++m_pos;
+            }
+        }
+        // a leading zero must stand alone, as in "0.5" but not "01"
+        if (atDigit()) {
+            return fail("Invalid number");
+        }
+
+        bool ok = false;
+        const QString number = m_json.mid(start, m_pos - start);
+        if (integer) {
+            const qlonglong result = number.toLongLong(&ok);
+            if (ok) {
+                return result;
+            }
+        }
+        const double result = number.toDouble(&ok);
+        return ok ? QVariant(result) : fail("Invalid number");
+    }
+
+    QVariant literal(const char *word, const QVariant &result)
+    {
+        const QString expected = QString::fromLatin1(word);
+        if (m_json.mid(m_pos, expected.length()) != expected) {
+            return fail();
+        }
+        m_pos += expected.length();
+        return result;
+    }
+
+    QString m_json;
+    int m_pos;
+    bool m_failed;
+    QString m_error;
+};
+
+}
+
+QVariant Config::parseJson(const QString &json, QString *error)
+{
+    JsonParser::Reader reader(json);
+    const QVariant result = reader.parse();
+    *error = reader.error();
+    return reader.failed() ? QVariant() : result;
+}
+
 static const struct QCommandLineConfigEntry flags[] =
 {
     { QCommandLine::Option, '\0', "cookies-file", "Sets the file name to store the persistent cookies", QCommandLine::Optional },
@@ -66,6 +359,25 @@ static const struct QCommandLineConfigEntry flags[] =
     { QCommandLine::Option, '\0', "script-encoding", "Sets the encoding used for the starting script, default is 'utf8'", QCommandLine::Optional },
     { QCommandLine::Option, '\0', "web-security", "Enables web security, 'yes' (default) or 'no'", QCommandLine::Optional },
     { QCommandLine::Option, '\0', "pac", "Sets the auto-config proxy url, e.g. '--pac=http://proxy.company.com/autoproxy.pac'", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "pac-cache-ttl", "Sets for how long (in seconds) auto-config proxy results and lookups are reused, default is 300; '0' disables it", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "max-connections-per-host", "Sets how many connections are opened in parallel to each host, default is 6", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "host-connections", "Overrides the connections per host for some hosts, e.g. '--host-connections=cdn.company.com:16,.static.company.com:12'", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "http-pipelining", "Pipelines idempotent HTTP requests on each connection: 'yes' or 'no' (default)", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "http-pipeline-length", "Sets how many requests are pipelined on a connection, default is 3", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "shared-connections", "Shares the keep-alive connections between all the pages, whatever their credentials, proxy or SSL settings: 'yes' or 'no' (default)", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "connection-idle-timeout", "Sets for how long (in seconds) an idle keep-alive connection is kept, default is 120", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "ssl-session-resumption", "Resumes the SSL sessions of previous connections to the same host: 'yes' (default) or 'no'", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "dns-cache-size", "Sets how many host name lookups are cached, default is 64", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "dns-cache-ttl", "Sets for how long (in seconds) a host name lookup is reused, default is 60", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "dns-lookup-threads", "Sets how many host names are looked up in parallel, default is 5", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "dns-cache-file", "Restores the host name lookup cache from the file specified and saves it there on exit", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "dns-prefetch", "Resolves the hosts of the resources of a page ahead of their requests: 'yes' or 'no' (default)", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "url-blocklist", "Never requests the URLs matching the rules of the file specified (hosts, URL prefixes or wildcard patterns, one per line)", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "memory-cache-size", "Limits the size of the in-memory cache of images, scripts, style sheets and fonts (in KB), default is 8192", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "memory-cache-min-dead-size", "Sets how much of the memory cache (in KB) resources no page uses keep under memory pressure, default is 0", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "memory-cache-max-dead-size", "Sets how much of the memory cache (in KB) resources no page uses can take, default is the memory cache size", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "max-pages-in-cache", "Sets how many pages are kept in memory for going back and forward in history, default is 0", QCommandLine::Optional },
+    { QCommandLine::Option, '\0', "compile-cache-path", "Keeps compiled CoffeeScript in the directory specified and reuses it for unchanged sources", QCommandLine::Optional },
     { QCommandLine::Option, '\0', "cert-authorities-path", "Loads CA Root certificates from the location specified", QCommandLine::Optional },
     { QCommandLine::Option, '\0', "local-certificate-file", "Sets Personal Certificate File (PKCS 12 Format)", QCommandLine::Optional },
     { QCommandLine::Option, '\0', "local-certificate-passphrase", "Sets the Personal Certificate Pass Phrase", QCommandLine::Optional },
@@ -128,15 +440,21 @@ void Config::loadJsonFile(const QString &filePath)
         return;
     }
 
-    // Load configurator
-    QString configurator = Utils::readResourceFileUtf8(":/configurator.js");
+    QString error;
+    const QVariantMap settings = parseJson(jsonConfig, &error).toMap();
+    if (!error.isEmpty()) {
+        Terminal::instance()->cerr("Config file MUST be in JSON format! " + error);
+        return;
+    }
 
-    // Use a temporary QWebPage to load the JSON configuration in this Object using the 'configurator' above
-    QWebPage webPage;
-    // Add this object to the global scope
-    webPage.mainFrame()->addToJavaScriptWindowObject("config", this);
-    // Apply the JSON config settings to this very object
-    webPage.mainFrame()->evaluateJavaScript(configurator.arg(jsonConfig), QString());
+    // Apply the JSON config settings to the properties of this very object
+    QVariantMap::const_iterator it = settings.constBegin();
+    for (; it != settings.constEnd(); ++it) {
+        const QByteArray name = it.key().toLatin1();
+        if (metaObject()->indexOfProperty(name.constData()) != -1) {
+            setProperty(name.constData(), it.value());
+        }
+    }
 }
 
 QString Config::helpText() const
@@ -460,6 +778,25 @@ void Config::resetToDefaults()
     m_javascriptCanCloseWindows = true;
     m_helpFlag = false;
     m_printDebugMessages = false;
+    m_proxyAutoConfigCacheTtl = 300;
+    m_compileCachePath.clear();
+    m_maxConnectionsPerHost = 6;
+    m_hostConnections.clear();
+    m_httpPipeliningEnabled = false;
+    m_httpPipelineLength = 3;
+    m_sharedConnectionsEnabled = false;
+    m_connectionIdleTimeout = 120;
+    m_sslSessionResumptionEnabled = true;
+    m_dnsCacheSize = 64;
+    m_dnsCacheTtl = 60;
+    m_dnsLookupThreads = 5;
+    m_dnsCacheFile.clear();
+    m_dnsPrefetchEnabled = false;
+    m_urlBlocklistFile.clear();
+    m_memoryCacheSize = -1;
+    m_memoryCacheMinDeadSize = -1;
+    m_memoryCacheMaxDeadSize = -1;
+    m_maxPagesInCache = -1;
 }
 
 void Config::setProxyAuthPass(const QString &value)
@@ -512,6 +849,212 @@ QString Config::proxyAutoConfig() const
     return m_proxyAutoConfig;
 }
 
+void Config::setProxyAutoConfigCacheTtl(const int value)
+{
+    m_proxyAutoConfigCacheTtl = value;
+}
+
+int Config::proxyAutoConfigCacheTtl() const
+{
+    return m_proxyAutoConfigCacheTtl;
+}
+
+void Config::setCompileCachePath(const QString &dirPath)
+{
+    m_compileCachePath = dirPath;
+}
+
+QString Config::compileCachePath() const
+{
+    return m_compileCachePath;
+}
+
+int Config::maxConnectionsPerHost() const
+{
+    return m_maxConnectionsPerHost;
+}
+
+void Config::setMaxConnectionsPerHost(const int value)
+{
+    m_maxConnectionsPerHost = value;
+}
+
+QVariantMap Config::hostConnections() const
+{
+    return m_hostConnections;
+}
+
+void Config::setHostConnections(const QVariantMap &value)
+{
+    m_hostConnections = value;
+}
+
+void Config::setHostConnections(const QString &value)
+{
+    // "host:count[,host:count...]"
+    m_hostConnections.clear();
+    foreach (const QString &entry, value.split(',', QString::SkipEmptyParts)) {
+        const int colon = entry.lastIndexOf(':');
+        bool ok = false;
+        const int count = colon > 0 ? entry.mid(colon + 1).toInt(&ok) : 0;
+        if (!ok || count <= 0) {
+            setUnknownOption(QString("Invalid value for 'host-connections' option: '%1'").arg(entry));
+            return;
+        }
+        m_hostConnections[entry.left(colon).trimmed().toLower()] = count;
+    }
+}
+
+bool Config::httpPipeliningEnabled() const
+{
+    return m_httpPipeliningEnabled;
+}
+
+void Config::setHttpPipeliningEnabled(const bool value)
+{
+    m_httpPipeliningEnabled = value;
+}
+
+int Config::httpPipelineLength() const
+{
+    return m_httpPipelineLength;
+}
+
+void Config::setHttpPipelineLength(const int value)
+{
+    m_httpPipelineLength = value;
+}
+
+bool Config::sharedConnectionsEnabled() const
+{
+    return m_sharedConnectionsEnabled;
+}
+
+void Config::setSharedConnectionsEnabled(const bool value)
+{
+    m_sharedConnectionsEnabled = value;
+}
+
+int Config::connectionIdleTimeout() const
+{
+    return m_connectionIdleTimeout;
+}
+
+void Config::setConnectionIdleTimeout(const int value)
+{
+    m_connectionIdleTimeout = value;
+}
+
+bool Config::sslSessionResumptionEnabled() const
+{
+    return m_sslSessionResumptionEnabled;
+}
+
+void Config::setSslSessionResumptionEnabled(const bool value)
+{
+    m_sslSessionResumptionEnabled = value;
+}
+
+int Config::dnsCacheSize() const
+{
+    return m_dnsCacheSize;
+}
+
+void Config::setDnsCacheSize(const int value)
+{
+    m_dnsCacheSize = value;
+}
+
+int Config::dnsCacheTtl() const
+{
+    return m_dnsCacheTtl;
+}
+
+void Config::setDnsCacheTtl(const int value)
+{
+    m_dnsCacheTtl = value;
+}
+
+int Config::dnsLookupThreads() const
+{
+    return m_dnsLookupThreads;
+}
+
+void Config::setDnsLookupThreads(const int value)
+{
+    m_dnsLookupThreads = value;
+}
+
+QString Config::dnsCacheFile() const
+{
+    return m_dnsCacheFile;
+}
+
+void Config::setDnsCacheFile(const QString &filePath)
+{
+    m_dnsCacheFile = filePath;
+}
+
+bool Config::dnsPrefetchEnabled() const
+{
+    return m_dnsPrefetchEnabled;
+}
+
+void Config::setDnsPrefetchEnabled(const bool value)
+{
+    m_dnsPrefetchEnabled = value;
+}
+
+QString Config::urlBlocklistFile() const
+{
+    return m_urlBlocklistFile;
+}
+
+void Config::setUrlBlocklistFile(const QString &filePath)
+{
+    m_urlBlocklistFile = filePath;
+}
+
+int Config::memoryCacheSize() const
+{
+    return m_memoryCacheSize;
+}
+
+void Config::setMemoryCacheSize(const int value)
+{
+    m_memoryCacheSize = value;
+}
+
+int Config::memoryCacheMinDeadSize() const
+{
+    return m_memoryCacheMinDeadSize;
+}
+
+void Config::setMemoryCacheMinDeadSize(const int value)
+{
+    m_memoryCacheMinDeadSize = value;
+}
+
+int Config::memoryCacheMaxDeadSize() const
+{
+    return m_memoryCacheMaxDeadSize;
+}
+
+void Config::setMemoryCacheMaxDeadSize(const int value)
+{
+    m_memoryCacheMaxDeadSize = value;
+}
+
+int Config::maxPagesInCache() const
+{
+    return m_maxPagesInCache;
+}
+
+void Config::setMaxPagesInCache(const int value)
+{
+    m_maxPagesInCache = value;
+}
+
 QString Config::certAuthoritiesPath() const
 {
     return m_certAuthoritiesPath;
@@ -575,10 +1118,14 @@ void Config::handleOption(const QString &option, const QVariant &value)
     QStringList booleanFlags;
     booleanFlags << "debug";
     booleanFlags << "disk-cache";
+    booleanFlags << "dns-prefetch";
+    booleanFlags << "http-pipelining";
     booleanFlags << "ignore-ssl-errors";
     booleanFlags << "load-images";
     booleanFlags << "local-to-remote-url-access";
     booleanFlags << "remote-debugger-autorun";
+    booleanFlags << "shared-connections";
+    booleanFlags << "ssl-session-resumption";
     booleanFlags << "web-security";
     if (booleanFlags.contains(option)) {
         if ((value != "true") && (value != "yes") && (value != "false") && (value != "no")) {
@@ -664,6 +1211,82 @@ void Config::handleOption(const QString &option, const QVariant &value)
     if (option == "pac") {
         setProxyAutoConfig(value.toString());
     }
+
+    if (option == "pac-cache-ttl") {
+        setProxyAutoConfigCacheTtl(value.toInt());
+    }
+
+    if (option == "max-connections-per-host") {
+        setMaxConnectionsPerHost(value.toInt());
+    }
+
+    if (option == "host-connections") {
+        setHostConnections(value.toString());
+    }
+
+    if (option == "http-pipelining") {
+        setHttpPipeliningEnabled(boolValue);
+    }
+
+    if (option == "http-pipeline-length") {
+        setHttpPipelineLength(value.toInt());
+    }
+
+    if (option == "shared-connections") {
+        setSharedConnectionsEnabled(boolValue);
+    }
+
+    if (option == "connection-idle-timeout") {
+        setConnectionIdleTimeout(value.toInt());
+    }
+
+    if (option == "ssl-session-resumption") {
+        setSslSessionResumptionEnabled(boolValue);
+    }
+
+    if (option == "dns-cache-size") {
+        setDnsCacheSize(value.toInt());
+    }
+
+    if (option == "dns-cache-ttl") {
+        setDnsCacheTtl(value.toInt());
+    }
+
+    if (option == "dns-lookup-threads") {
+        setDnsLookupThreads(value.toInt());
+    }
+
+    if (option == "dns-cache-file") {
+        setDnsCacheFile(value.toString());
+    }
+
+    if (option == "dns-prefetch") {
+        setDnsPrefetchEnabled(boolValue);
+    }
+
+    if (option == "url-blocklist") {
+        setUrlBlocklistFile(value.toString());
+    }
+
+    if (option == "memory-cache-size") {
+        setMemoryCacheSize(value.toInt());
+    }
+
+    if (option == "memory-cache-min-dead-size") {
+        setMemoryCacheMinDeadSize(value.toInt());
+    }
+
+    if (option == "memory-cache-max-dead-size") {
+        setMemoryCacheMaxDeadSize(value.toInt());
+    }
+
+    if (option == "max-pages-in-cache") {
+        setMaxPagesInCache(value.toInt());
+    }
+
+    if (option == "compile-cache-path") {
+        setCompileCachePath(value.toString());
+    }
     
     if (option == "cert-authorities-path") {
         setCertAuthoritiesPath(value.toString());
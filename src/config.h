@@ -56,6 +56,25 @@ class Config: QObject
     Q_PROPERTY(int offlineStorageDefaultQuota READ offlineStorageDefaultQuota WRITE setOfflineStorageDefaultQuota)
     Q_PROPERTY(bool printDebugMessages READ printDebugMessages WRITE setPrintDebugMessages)
     Q_PROPERTY(QString proxyAutoConfig READ proxyAutoConfig WRITE setProxyAutoConfig)
+    Q_PROPERTY(int proxyAutoConfigCacheTtl READ proxyAutoConfigCacheTtl WRITE setProxyAutoConfigCacheTtl)
+    Q_PROPERTY(QString compileCachePath READ compileCachePath WRITE setCompileCachePath)
+    Q_PROPERTY(int maxConnectionsPerHost READ maxConnectionsPerHost WRITE setMaxConnectionsPerHost)
+    Q_PROPERTY(QVariantMap hostConnections READ hostConnections WRITE setHostConnections)
+    Q_PROPERTY(bool httpPipeliningEnabled READ httpPipeliningEnabled WRITE setHttpPipeliningEnabled)
+    Q_PROPERTY(int httpPipelineLength READ httpPipelineLength WRITE setHttpPipelineLength)
+    Q_PROPERTY(bool sharedConnectionsEnabled READ sharedConnectionsEnabled WRITE setSharedConnectionsEnabled)
+    Q_PROPERTY(int connectionIdleTimeout READ connectionIdleTimeout WRITE setConnectionIdleTimeout)
+    Q_PROPERTY(bool sslSessionResumptionEnabled READ sslSessionResumptionEnabled WRITE setSslSessionResumptionEnabled)
+    Q_PROPERTY(int dnsCacheSize READ dnsCacheSize WRITE setDnsCacheSize)
+    Q_PROPERTY(int dnsCacheTtl READ dnsCacheTtl WRITE setDnsCacheTtl)
+    Q_PROPERTY(int dnsLookupThreads READ dnsLookupThreads WRITE setDnsLookupThreads)
+    Q_PROPERTY(QString dnsCacheFile READ dnsCacheFile WRITE setDnsCacheFile)
+    Q_PROPERTY(bool dnsPrefetchEnabled READ dnsPrefetchEnabled WRITE setDnsPrefetchEnabled)
+    Q_PROPERTY(QString urlBlocklistFile READ urlBlocklistFile WRITE setUrlBlocklistFile)
+    Q_PROPERTY(int memoryCacheSize READ memoryCacheSize WRITE setMemoryCacheSize)
+    Q_PROPERTY(int memoryCacheMinDeadSize READ memoryCacheMinDeadSize WRITE setMemoryCacheMinDeadSize)
+    Q_PROPERTY(int memoryCacheMaxDeadSize READ memoryCacheMaxDeadSize WRITE setMemoryCacheMaxDeadSize)
+    Q_PROPERTY(int maxPagesInCache READ maxPagesInCache WRITE setMaxPagesInCache)
     Q_PROPERTY(QString certAuthoritiesPath READ certAuthoritiesPath WRITE setCertAuthoritiesPath)
     Q_PROPERTY(bool javascriptCanOpenWindows READ javascriptCanOpenWindows WRITE setJavascriptCanOpenWindows)
     Q_PROPERTY(bool javascriptCanCloseWindows READ javascriptCanCloseWindows WRITE setJavascriptCanCloseWindows)
@@ -69,6 +88,13 @@ public:
     void processArgs(const QStringList &args);
     void loadJsonFile(const QString &filePath);
 
+    /**
+     * Parses JSON (RFC 4627) text, as read from the '--config' file.
+     * On failure an invalid QVariant is returned and @p error tells what
+     * and where, e.g. "Unexpected character ',' at line 3, column 12".
+     */
+    static QVariant parseJson(const QString &json, QString *error);
+
     QString helpText() const;
 
     bool autoLoadImages() const;
@@ -149,6 +175,64 @@ public:
     QString proxyAutoConfig() const;
     void setProxyAutoConfig(const QString &value);
 
+    int proxyAutoConfigCacheTtl() const;
+    void setProxyAutoConfigCacheTtl(const int value);
+
+    QString compileCachePath() const;
+    void setCompileCachePath(const QString &dirPath);
+
+    int maxConnectionsPerHost() const;
+    void setMaxConnectionsPerHost(const int value);
+
+    QVariantMap hostConnections() const;
+    void setHostConnections(const QVariantMap &value);
+    void setHostConnections(const QString &value);
+
+    bool httpPipeliningEnabled() const;
+    void setHttpPipeliningEnabled(const bool value);
+
+    int httpPipelineLength() const;
+    void setHttpPipelineLength(const int value);
+
+    bool sharedConnectionsEnabled() const;
+    void setSharedConnectionsEnabled(const bool value);
+
+    int connectionIdleTimeout() const;
+    void setConnectionIdleTimeout(const int value);
+
+    bool sslSessionResumptionEnabled() const;
+    void setSslSessionResumptionEnabled(const bool value);
+
+    int dnsCacheSize() const;
+    void setDnsCacheSize(const int value);
+
+    int dnsCacheTtl() const;
+    void setDnsCacheTtl(const int value);
+
+    int dnsLookupThreads() const;
+    void setDnsLookupThreads(const int value);
+
+    QString dnsCacheFile() const;
+    void setDnsCacheFile(const QString &filePath);
+
+    bool dnsPrefetchEnabled() const;
+    void setDnsPrefetchEnabled(const bool value);
+
+    QString urlBlocklistFile() const;
+    void setUrlBlocklistFile(const QString &filePath);
+
+    int memoryCacheSize() const;
+    void setMemoryCacheSize(const int value);
+
+    int memoryCacheMinDeadSize() const;
+    void setMemoryCacheMinDeadSize(const int value);
+
+    int memoryCacheMaxDeadSize() const;
+    void setMemoryCacheMaxDeadSize(const int value);
+
+    int maxPagesInCache() const;
+    void setMaxPagesInCache(const int value);
+
     QString certAuthoritiesPath() const;
     void setCertAuthoritiesPath(const QString &dirPath);      
     
@@ -205,6 +289,25 @@ private:
     bool m_helpFlag;
     bool m_printDebugMessages;
     QString m_proxyAutoConfig;
+    int m_proxyAutoConfigCacheTtl;
+    QString m_compileCachePath;
+    int m_maxConnectionsPerHost;
+    QVariantMap m_hostConnections;
+    bool m_httpPipeliningEnabled;
+    int m_httpPipelineLength;
+    bool m_sharedConnectionsEnabled;
+    int m_connectionIdleTimeout;
+    bool m_sslSessionResumptionEnabled;
+    int m_dnsCacheSize;
+    int m_dnsCacheTtl;
+    int m_dnsLookupThreads;
+    QString m_dnsCacheFile;
+    bool m_dnsPrefetchEnabled;
+    QString m_urlBlocklistFile;
+    int m_memoryCacheSize;
+    int m_memoryCacheMinDeadSize;
+    int m_memoryCacheMaxDeadSize;
+    int m_maxPagesInCache;
     QString m_certAuthoritiesPath;
     bool m_javascriptCanOpenWindows;
     bool m_javascriptCanCloseWindows;
@@ -61,5 +61,11 @@
 #define PAGE_SETTINGS_WEB_SECURITY_ENABLED  "webSecurityEnabled"
 #define PAGE_SETTINGS_JS_CAN_OPEN_WINDOWS   "javascriptCanOpenWindows"
 #define PAGE_SETTINGS_JS_CAN_CLOSE_WINDOWS  "javascriptCanCloseWindows"
+#define PAGE_SETTINGS_MAX_CONNECTIONS       "maxConnectionsPerHost"
+#define PAGE_SETTINGS_HOST_CONNECTIONS      "hostConnections"
+#define PAGE_SETTINGS_HTTP_PIPELINING       "httpPipelining"
+#define PAGE_SETTINGS_HTTP_PIPELINE_LENGTH  "httpPipelineLength"
+#define PAGE_SETTINGS_RESOURCE_TIMEOUT      "resourceTimeout"
+#define PAGE_SETTINGS_HOST_RESOURCE_TIMEOUTS "hostResourceTimeouts"
 
 #endif // CONSTS_H
@@ -33,10 +33,64 @@
 #include "cookiejar.h"
 
 #include <QDateTime>
+#include <QHostAddress>
 #include <QSettings>
 #include <QTimer>
 
 #define COOKIE_JAR_VERSION      1
+#define COOKIE_JAR_SAVE_DELAY   1000    //< msec: cookies set within this interval are saved at once
+#define COOKIE_JAR_MAX_PER_DOMAIN 50
+
+QT_BEGIN_NAMESPACE
+// Exported by QtCore (see "qtldurl_p.h")
+Q_CORE_EXPORT QString qTopLevelDomain(const QString &domain);
+Q_CORE_EXPORT bool qIsEffectiveTLD(const QString &domain);
+QT_END_NAMESPACE
+
+// Same matching rules as QNetworkCookieJar
+static inline bool isParentPath(QString path, QString reference)
+{
+    if (!path.endsWith(QLatin1Char('/')))
+        path += QLatin1Char('/');
+    if (!reference.endsWith(QLatin1Char('/')))
+        reference += QLatin1Char('/');
+    return path.startsWith(reference);
+}
+
+static inline bool isParentDomain(const QString &domain, const QString &reference)
+{
+    if (!reference.startsWith(QLatin1Char('.')))
+        return domain == reference;
+
+    return domain.endsWith(reference) || domain == reference.mid(1);
+}
+
+// Key of the cookies index: the registrable domain ("eTLD+1") of a host or cookie domain.
+// A cookie can only ever match hosts with the same registrable domain as its own.
+static QString registrableDomain(const QString &domain)
+{
+    QString host = domain.toLower();
+    if (host.startsWith(QLatin1Char('.')))
+        host.remove(0, 1);
+
+    if (!QHostAddress(host).isNull())
+        return host;
+
+    QString tld = qTopLevelDomain(host);
+    if (tld.isEmpty()) {
+        // Not under a known public suffix (e.g. "intranet.corp"): use the last label as one,
+        // so that "www.intranet.corp" gets the same key as a cookie for ".intranet.corp"
+        const int lastDot = host.lastIndexOf(QLatin1Char('.'));
+        if (lastDot < 0)
+            return host; // Single label, like "localhost"
+        tld = host.mid(lastDot);
+    }
+    if (tld.length() >= host.length())
+        return host;
+
+    const int labelStart = host.lastIndexOf(QLatin1Char('.'), host.length() - tld.length() - 1);
+    return host.mid(labelStart + 1);
+}
 
 // Operators needed for Cookie Serialization
 QT_BEGIN_NAMESPACE
@@ -84,6 +138,10 @@ CookieJar::CookieJar(QString cookiesFile, QObject *parent)
     , m_cookieStorage(new QSettings(cookiesFile, QSettings::IniFormat, this))
     , m_enabled(true)
 {
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(COOKIE_JAR_SAVE_DELAY);
+    connect(&m_saveTimer, SIGNAL(timeout()), this, SLOT(save()));
+
     load();
 }
 
@@ -107,6 +165,7 @@ CookieJar *CookieJar::instance(QString cookiesFile)
 CookieJar::~CookieJar()
 {
     // On destruction, before saving, clear all the session cookies
+    m_saveTimer.stop();
     purgeSessionCookies();
     save();
 }
@@ -115,8 +174,65 @@ bool CookieJar::setCookiesFromUrl(const QList<QNetworkCookie> & cookieList, cons
 {
     // Update cookies in memory
     if (isEnabled()) {
-        QNetworkCookieJar::setCookiesFromUrl(cookieList, url);
-        save();
+        // Same validation as QNetworkCookieJar, but only the cookies of the same domain are looked at
+        QString defaultDomain = url.host();
+        QString pathAndFileName = url.path();
+        QString defaultPath = pathAndFileName.left(pathAndFileName.lastIndexOf(QLatin1Char('/')) + 1);
+        if (defaultPath.isEmpty())
+            defaultPath = QLatin1Char('/');
+
+        QDateTime now = QDateTime::currentDateTime();
+        foreach (QNetworkCookie cookie, cookieList) {
+            bool isDeletion = !cookie.isSessionCookie() && cookie.expirationDate() < now;
+
+            if (cookie.path().isEmpty())
+                cookie.setPath(defaultPath);
+            if (cookie.domain().isEmpty()) {
+                cookie.setDomain(defaultDomain);
+            } else {
+                if (!cookie.domain().startsWith(QLatin1Char('.')))
+                    cookie.setDomain(QLatin1Char('.') + cookie.domain());
+
+                QString domain = cookie.domain();
+                if (!(isParentDomain(domain, defaultDomain) || isParentDomain(defaultDomain, domain)))
+                    continue; // not accepted
+                if (qIsEffectiveTLD(domain.remove(0, 1)))
+                    continue; // not accepted
+            }
+
+            QList<QNetworkCookie> &domainCookies = m_cookies[registrableDomain(cookie.domain())];
+            for (int i = 0; i < domainCookies.size(); ++i) {
+                // Replace the cookie if it already exists
+                const QNetworkCookie &current = domainCookies.at(i);
+                if (cookie.name() == current.name() &&
+                    cookie.domain() == current.domain() &&
+                    cookie.path() == current.path()) {
+                    domainCookies.removeAt(i);
+                    break;
+                }
+            }
+
+            if (!isDeletion) {
+                // Start from the end and delete the oldest cookies to keep a maximum count per domain
+                int countForDomain = 0;
+                for (int i = domainCookies.size() - 1; i >= 0; --i) {
+                    const QNetworkCookie &current = domainCookies.at(i);
+                    if (isParentDomain(cookie.domain(), current.domain()) ||
+                        isParentDomain(current.domain(), cookie.domain())) {
+                        if (countForDomain >= COOKIE_JAR_MAX_PER_DOMAIN - 1)
+                            domainCookies.removeAt(i);
+                        else
+                            ++countForDomain;
+                    }
+                }
+                domainCookies.append(cookie);
+            } else if (domainCookies.isEmpty()) {
+                m_cookies.remove(registrableDomain(cookie.domain()));
+            }
+        }
+
+        // Pages set many cookies while loading: write them out in one go
+        scheduleSave();
     }
     // No changes occurred
     return false;
@@ -124,11 +240,36 @@ bool CookieJar::setCookiesFromUrl(const QList<QNetworkCookie> & cookieList, cons
 
 QList<QNetworkCookie> CookieJar::cookiesForUrl(const QUrl &url) const
 {
-    if (isEnabled()) {
-        return QNetworkCookieJar::cookiesForUrl(url);
+    QList<QNetworkCookie> result;
+    if (!isEnabled()) {
+        // The CookieJar is disabled: don't return any cookie
+        return result;
     }
-    // The CookieJar is disabled: don't return any cookie
-    return QList<QNetworkCookie>();
+
+    const QString host = url.host();
+    const QString path = url.path();
+    const bool isEncrypted = url.scheme().toLower() == QLatin1String("https");
+    const QDateTime now = QDateTime::currentDateTime();
+
+    // Only the cookies of the same registrable domain can match
+    const QList<QNetworkCookie> domainCookies = m_cookies.value(registrableDomain(host));
+    foreach (const QNetworkCookie &cookie, domainCookies) {
+        if (!isParentDomain(host, cookie.domain()))
+            continue;
+        if (!isParentPath(path, cookie.path()))
+            continue;
+        if (!cookie.isSessionCookie() && cookie.expirationDate() < now)
+            continue;
+        if (cookie.isSecure() && !isEncrypted)
+            continue;
+
+        // Sort by decreasing path length, as QNetworkCookieJar does
+        QList<QNetworkCookie>::Iterator insertIt = result.begin();
+        while (insertIt != result.end() && insertIt->path().length() >= cookie.path().length())
+            ++insertIt;
+        result.insert(insertIt, cookie);
+    }
+    return result;
 }
 
 bool CookieJar::addCookie(const QNetworkCookie &cookie, const QString &url)
@@ -485,7 +626,9 @@ void CookieJar::load()
 
 bool CookieJar::contains(const QNetworkCookie &cookie) const
 {
-    QList<QNetworkCookie> cookiesList = allCookies();
+    QList<QNetworkCookie> cookiesList = cookie.domain().isEmpty() ?
+        allCookies() :
+        m_cookies.value(registrableDomain(cookie.domain()));
     for (int i = cookiesList.length() -1; i >= 0; --i) {
         if (cookie.name() == cookiesList.at(i).name() &&
             cookie.value() == cookiesList.at(i).value() &&
@@ -501,3 +644,29 @@ bool CookieJar::contains(const QNetworkCookie &cookie) const
 
     return false;
 }
+
+void CookieJar::scheduleSave()
+{
+    // Don't restart a pending timer: a steady stream of cookies must not postpone saving forever
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+QList<QNetworkCookie> CookieJar::allCookies() const
+{
+    QList<QNetworkCookie> cookiesList;
+    QHash<QString, QList<QNetworkCookie> >::const_iterator it = m_cookies.constBegin();
+    for (; it != m_cookies.constEnd(); ++it) {
+        cookiesList.append(it.value());
+    }
+    return cookiesList;
+}
+
+void CookieJar::setAllCookies(const QList<QNetworkCookie> &cookieList)
+{
+    m_cookies.clear();
+    foreach (const QNetworkCookie &cookie, cookieList) {
+        m_cookies[registrableDomain(cookie.domain())].append(cookie);
+    }
+}
@@ -31,8 +31,10 @@
 #ifndef COOKIEJAR_H
 #define COOKIEJAR_H
 
+#include <QHash>
 #include <QSettings>
 #include <QNetworkCookieJar>
+#include <QTimer>
 #include <QVariantList>
 #include <QVariantMap>
 
@@ -77,9 +79,17 @@ private slots:
 
 private:
     bool contains(const QNetworkCookie &cookie) const;
+    void scheduleSave();
+
+    // Cookies are kept in "m_cookies", indexed by registrable domain:
+    // these hide the flat list of QNetworkCookieJar, that is never used
+    QList<QNetworkCookie> allCookies() const;
+    void setAllCookies(const QList<QNetworkCookie> &cookieList);
 
 private:
     QSettings *m_cookieStorage;
+    QHash<QString, QList<QNetworkCookie> > m_cookies;
+    QTimer m_saveTimer;
     bool m_enabled;
 };
 
@@ -30,11 +30,14 @@
 #include "csconverter.h"
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QWebFrame>
 
 #include "utils.h"
 #include "terminal.h"
 
+#define COFFEE_SCRIPT_RESOURCE ":/coffee-script/extras/coffee-script.js"
+
 static CSConverter *csconverter_instance = 0;
 
 CSConverter *CSConverter::instance()
@@ -49,7 +52,7 @@ CSConverter::CSConverter()
     : QObject(QCoreApplication::instance())
 {
     m_webPage.mainFrame()->evaluateJavaScript(
-        Utils::readResourceFileUtf8(":/coffee-script/extras/coffee-script.js"),
+        Utils::readResourceFileUtf8(COFFEE_SCRIPT_RESOURCE),
         QString("phantomjs://coffee-script/extras/coffee-script.js")
     );
     m_webPage.mainFrame()->addToJavaScriptWindowObject("converter", this);
@@ -68,3 +71,14 @@ QVariant CSConverter::convert(const QString &script)
     );
     return result;
 }
+
+QString CSConverter::compilerId()
+{
+    static QString id;
+    if (id.isEmpty()) {
+        QFile compiler(COFFEE_SCRIPT_RESOURCE);
+        compiler.open(QFile::ReadOnly);
+        id = QString("coffee-script/") + QCryptographicHash::hash(compiler.readAll(), QCryptographicHash::Sha1).toHex();
+    }
+    return id;
+}
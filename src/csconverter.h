@@ -39,6 +39,9 @@ public:
     static CSConverter *instance();
     QVariant convert(const QString &script);
 
+    /// identifies the bundled compiler, for caching its output
+    static QString compilerId();
+
 private:
     CSConverter();
     QWebPage m_webPage;
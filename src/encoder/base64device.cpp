@@ -0,0 +1,77 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "base64device.h"
+
+Base64Device::Base64Device(QIODevice *target, QObject *parent)
+    : QIODevice(parent)
+    , m_target(target)
+{
+}
+
+Base64Device::~Base64Device()
+{
+    close();
+}
+
+bool Base64Device::isSequential() const
+{
+    return true;
+}
+
+void Base64Device::close()
+{
+    if (!isOpen())
+        return;
+
+    // Flush the remaining bytes, padding included
+    m_target->write(m_pending.toBase64());
+    m_pending.clear();
+    QIODevice::close();
+}
+
+qint64 Base64Device::readData(char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 Base64Device::writeData(const char *data, qint64 size)
+{
+    m_pending.append(data, size);
+
+    // Only encode whole 3-byte groups, so that the chunks can be concatenated
+    const int usable = m_pending.size() - m_pending.size() % 3;
+    if (usable > 0) {
+        const QByteArray encoded = QByteArray::fromRawData(m_pending.constData(), usable).toBase64();
+        if (m_target->write(encoded) != encoded.size())
+            return -1;
+        m_pending.remove(0, usable);
+    }
+    return size;
+}
@@ -0,0 +1,13 @@
+VPATH += $$PWD
+INCLUDEPATH += $$PWD
+
+SOURCES += stripencoder.cpp
+SOURCES += base64device.cpp
+
+HEADERS += stripencoder.h
+HEADERS += base64device.h
+
+# The streaming encoders drive the bundled libpng/libjpeg directly,
+# the same way the Qt image plugins do.
+include(../qt/src/3rdparty/libpng.pri)
+include(../qt/src/3rdparty/libjpeg.pri)
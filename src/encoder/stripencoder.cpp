@@ -0,0 +1,363 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "stripencoder.h"
+
+#include <QIODevice>
+
+#include <stdio.h>      // jpeglib needs this to be pre-included
+#include <setjmp.h>
+
+#include <png.h>
+
+#ifdef FAR
+#undef FAR
+#endif
+
+extern "C" {
+#define XMD_H           // shut JPEGlib up
+#include <jpeglib.h>
+#ifdef const
+#  undef const          // remove crazy C hackery in jconfig.h
+#endif
+}
+
+/**
+ * Format specific part of the StripEncoder.
+ * Rows handed to the backends are always in QImage::Format_ARGB32.
+ */
+class StripEncoderBackend
+{
+public:
+    virtual ~StripEncoderBackend() {}
+    virtual bool begin(QIODevice *device, const QSize &size, int quality) = 0;
+    virtual bool writeRows(const QImage &strip) = 0;
+    virtual bool finish() = 0;
+};
+
+
+// PNG
+
+static void pngWriteData(png_structp png, png_bytep data, png_size_t length)
+{
+    QIODevice *device = (QIODevice *)png_get_io_ptr(png);
+    if (device->write((const char *)data, length) != (qint64)length) {
+        png_error(png, "Write Error");
+    }
+}
+
+static void pngFlushData(png_structp png)
+{
+    Q_UNUSED(png);
+}
+
+class PngStripEncoder : public StripEncoderBackend
+{
+public:
+    PngStripEncoder()
+        : m_png(NULL)
+        , m_info(NULL)
+    {
+    }
+
+    ~PngStripEncoder()
+    {
+        if (m_png) {
+            png_destroy_write_struct(&m_png, &m_info);
+        }
+    }
+
+    bool begin(QIODevice *device, const QSize &size, int quality)
+    {
+        m_png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+        if (!m_png) {
+            return false;
+        }
+        m_info = png_create_info_struct(m_png);
+        if (!m_info) {
+            return false;
+        }
+        if (setjmp(png_jmpbuf(m_png))) {
+            return false;
+        }
+
+        png_set_write_fn(m_png, device, pngWriteData, pngFlushData);
+
+        // Same mapping of "quality" to zlib compression level as QImageWriter
+        if (quality >= 0) {
+            png_set_compression_level(m_png, (100 - qMin(quality, 100)) * 9 / 91);
+        }
+
+        png_set_IHDR(m_png, m_info, size.width(), size.height(), 8,
+                     PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
+                     PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(m_png, m_info);
+
+        // Rows are given in the in-memory layout of QImage::Format_ARGB32
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        png_set_swap_alpha(m_png);
+#else
+        png_set_bgr(m_png);
+#endif
+        return true;
+    }
+
+    bool writeRows(const QImage &strip)
+    {
+        if (setjmp(png_jmpbuf(m_png))) {
+            return false;
+        }
+        for (int y = 0; y < strip.height(); ++y) {
+            png_write_row(m_png, (png_bytep)strip.constScanLine(y));
+        }
+        return true;
+    }
+
+    bool finish()
+    {
+        if (setjmp(png_jmpbuf(m_png))) {
+            return false;
+        }
+        png_write_end(m_png, m_info);
+        return true;
+    }
+
+private:
+    png_structp m_png;
+    png_infop m_info;
+};
+
+
+// JPEG
+
+static const int JPEG_BUFFER_SIZE = 4096;
+static const int JPEG_DEFAULT_QUALITY = 75;
+
+struct JpegDestination : public jpeg_destination_mgr
+{
+    QIODevice *device;
+    JOCTET buffer[JPEG_BUFFER_SIZE];
+};
+
+struct JpegErrorManager : public jpeg_error_mgr
+{
+    jmp_buf setjmpBuffer;
+};
+
+extern "C" {
+
+static void jpegInitDestination(j_compress_ptr cinfo)
+{
+    Q_UNUSED(cinfo);
+}
+
+static boolean jpegEmptyOutputBuffer(j_compress_ptr cinfo)
+{
+    JpegDestination *dest = (JpegDestination *)cinfo->dest;
+    if (dest->device->write((const char *)dest->buffer, JPEG_BUFFER_SIZE) != JPEG_BUFFER_SIZE) {
+        (*cinfo->err->error_exit)((j_common_ptr)cinfo);
+    }
+    dest->next_output_byte = dest->buffer;
+    dest->free_in_buffer = JPEG_BUFFER_SIZE;
+    return TRUE;
+}
+
+static void jpegTermDestination(j_compress_ptr cinfo)
+{
+    JpegDestination *dest = (JpegDestination *)cinfo->dest;
+    qint64 pending = JPEG_BUFFER_SIZE - dest->free_in_buffer;
+    if (dest->device->write((const char *)dest->buffer, pending) != pending) {
+        (*cinfo->err->error_exit)((j_common_ptr)cinfo);
+    }
+}
+
+static void jpegErrorExit(j_common_ptr cinfo)
+{
+    JpegErrorManager *err = (JpegErrorManager *)cinfo->err;
+    char buffer[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, buffer);
+    qWarning("%s", buffer);
+    longjmp(err->setjmpBuffer, 1);
+}
+
+}
+
+class JpegStripEncoder : public StripEncoderBackend
+{
+public:
+    JpegStripEncoder()
+        : m_created(false)
+        , m_row(NULL)
+    {
+    }
+
+    ~JpegStripEncoder()
+    {
+        if (m_created) {
+            jpeg_destroy_compress(&m_cinfo);
+        }
+        delete [] m_row;
+    }
+
+    bool begin(QIODevice *device, const QSize &size, int quality)
+    {
+        m_cinfo.err = jpeg_std_error(&m_error);
+        m_error.error_exit = jpegErrorExit;
+        if (setjmp(m_error.setjmpBuffer)) {
+            return false;
+        }
+
+        jpeg_create_compress(&m_cinfo);
+        m_created = true;
+
+        m_destination.init_destination = jpegInitDestination;
+        m_destination.empty_output_buffer = jpegEmptyOutputBuffer;
+        m_destination.term_destination = jpegTermDestination;
+        m_destination.device = device;
+        m_destination.next_output_byte = m_destination.buffer;
+        m_destination.free_in_buffer = JPEG_BUFFER_SIZE;
+        m_cinfo.dest = &m_destination;
+
+        m_cinfo.image_width = size.width();
+        m_cinfo.image_height = size.height();
+        m_cinfo.input_components = 3;
+        m_cinfo.in_color_space = JCS_RGB;
+        jpeg_set_defaults(&m_cinfo);
+        jpeg_set_quality(&m_cinfo, quality >= 0 ? qMin(quality, 100) : JPEG_DEFAULT_QUALITY, TRUE);
+        jpeg_start_compress(&m_cinfo, TRUE);
+
+        m_row = new JSAMPLE[size.width() * 3];
+        return true;
+    }
+
+    bool writeRows(const QImage &strip)
+    {
+        if (setjmp(m_error.setjmpBuffer)) {
+            return false;
+        }
+        JSAMPROW rowPointer = m_row;
+        for (int y = 0; y < strip.height(); ++y) {
+            const QRgb *src = (const QRgb *)strip.constScanLine(y);
+            JSAMPLE *dst = m_row;
+            for (int x = 0; x < strip.width(); ++x) {
+                *dst++ = qRed(src[x]);
+                *dst++ = qGreen(src[x]);
+                *dst++ = qBlue(src[x]);
+            }
+            jpeg_write_scanlines(&m_cinfo, &rowPointer, 1);
+        }
+        return true;
+    }
+
+    bool finish()
+    {
+        if (setjmp(m_error.setjmpBuffer)) {
+            return false;
+        }
+        jpeg_finish_compress(&m_cinfo);
+        return true;
+    }
+
+private:
+    jpeg_compress_struct m_cinfo;
+    JpegErrorManager m_error;
+    JpegDestination m_destination;
+    bool m_created;
+    JSAMPLE *m_row;
+};
+
+
+// StripEncoder
+
+StripEncoder::StripEncoder(QIODevice *device, const QByteArray &format, int quality)
+    : m_device(device)
+    , m_format(format.toLower())
+    , m_quality(quality)
+    , m_rowsWritten(0)
+    , m_backend(NULL)
+{
+}
+
+StripEncoder::~StripEncoder()
+{
+    delete m_backend;
+}
+
+bool StripEncoder::supportsFormat(const QByteArray &format)
+{
+    const QByteArray f = format.toLower();
+    return f == "png" || f == "jpg" || f == "jpeg";
+}
+
+bool StripEncoder::begin(const QSize &size)
+{
+    if (m_backend || !m_device || size.isEmpty()) {
+        return false;
+    }
+
+    if (m_format == "png") {
+        m_backend = new PngStripEncoder;
+    } else if (m_format == "jpg" || m_format == "jpeg") {
+        m_backend = new JpegStripEncoder;
+    } else {
+        return false;
+    }
+
+    m_size = size;
+    m_rowsWritten = 0;
+    if (!m_backend->begin(m_device, m_size, m_quality)) {
+        delete m_backend;
+        m_backend = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool StripEncoder::write(const QImage &strip)
+{
+    if (!m_backend
+            || strip.width() != m_size.width()
+            || m_rowsWritten + strip.height() > m_size.height()) {
+        return false;
+    }
+
+    const QImage rows = strip.format() == QImage::Format_ARGB32 ?
+                strip : strip.convertToFormat(QImage::Format_ARGB32);
+    if (!m_backend->writeRows(rows)) {
+        return false;
+    }
+    m_rowsWritten += strip.height();
+    return true;
+}
+
+bool StripEncoder::finish()
+{
+    if (!m_backend || m_rowsWritten != m_size.height()) {
+        return false;
+    }
+    return m_backend->finish();
+}
@@ -0,0 +1,80 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef STRIPENCODER_H
+#define STRIPENCODER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+
+class QIODevice;
+class StripEncoderBackend;
+
+/**
+ * Encodes an image that is handed over as a sequence of horizontal strips,
+ * top to bottom, writing the result to a QIODevice as it goes.
+ *
+ * Unlike QImage::save(), the whole image never needs to be in memory:
+ * peak memory usage is bound by the height of the strips.
+ *
+ * Supported formats are "png", "jpg" and "jpeg".
+ */
+class StripEncoder
+{
+public:
+    StripEncoder(QIODevice *device, const QByteArray &format, int quality = -1);
+    ~StripEncoder();
+
+    static bool supportsFormat(const QByteArray &format);
+
+    /**
+     * Starts encoding an image of the given size.
+     *
+     * @return "false" if the format is not supported or the encoder failed
+     */
+    bool begin(const QSize &size);
+    /**
+     * Appends the rows of the given strip. The strip must be as wide as
+     * the image given to begin().
+     */
+    bool write(const QImage &strip);
+    /**
+     * Completes the image. Fails if fewer rows than announced were written.
+     */
+    bool finish();
+
+private:
+    QIODevice *m_device;
+    QByteArray m_format;
+    int m_quality;
+    QSize m_size;
+    int m_rowsWritten;
+    StripEncoderBackend *m_backend;
+};
+
+#endif // STRIPENCODER_H
@@ -224,6 +224,11 @@ int QuantizeBuffer(unsigned int Width, unsigned int Height,
                    GifByteType * GreenInput, GifByteType * BlueInput,
                    GifByteType * OutputBuffer,
                    GifColorType * OutputColorMap);
+int QuantizeRGB32Buffer(unsigned int Width, unsigned int Height,
+                        unsigned int BytesPerLine, int BitsPerPrimColor,
+                        int *ColorMapSize, const GifByteType * Input,
+                        GifByteType * OutputBuffer,
+                        GifColorType * OutputColorMap);
 
 /******************************************************************************
  * O.K., here are the routines from GIF_LIB file QPRINTF.C.              
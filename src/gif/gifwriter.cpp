@@ -29,90 +29,115 @@
 
 #include "gifwriter.h"
 
-#include "gif_lib.h"
-
 #include <QImage>
 #include <QFile>
 
+#include <limits.h>
+#include <string.h>
+
+// Beyond this many pixels the color histogram keeps 5 bits per primary color
+// instead of 7: clearing and sorting it is then much cheaper than on the
+// 2M entries of the full precision one.
+#define GIF_LARGE_FRAME_PIXELS (1024 * 1024)
+
 static int saveGifBlock(GifFileType *gif, const GifByteType *data, int i)
 {
     QFile *file = (QFile*)(gif->UserData);
     return file->write((const char*)data, i);
 }
 
-bool exportGif(const QImage &img, const QString &fileName)
+// The quantizer and the palette lookup read raw 0xAARRGGBB scanlines
+static QImage toRgb32(const QImage &image)
 {
-    QFile file;
-    file.setFileName(fileName);
-    if (!file.open(QFile::WriteOnly)) {
-        return false;
-    }
+    if (image.format() == QImage::Format_ARGB32 || image.format() == QImage::Format_RGB32)
+        return image;
+    return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+}
 
-    QImage image = img;
+// Points the fully transparent pixels at the given index, returns whether there were any
+static bool markTransparentPixels(const QImage &image, uchar *output, int index)
+{
+    if (!image.hasAlphaChannel())
+        return false;
 
-    int dim = image.width() * image.height();
-    GifByteType *rBuffer = new GifByteType[dim];
-    GifByteType *gBuffer = new GifByteType[dim];
-    GifByteType *bBuffer = new GifByteType[dim];
-    for (int i = 0; i < image.width(); ++i) {
-        for (int j = 0; j < image.height(); ++j) {
-            QRgb color = image.pixel(i, j);
-            rBuffer[i + j * image.width()] = qRed(color);
-            gBuffer[i + j * image.width()] = qGreen(color);
-            bBuffer[i + j * image.width()] = qBlue(color);
+    bool found = false;
+    const int width = image.width();
+    for (int y = 0; y < image.height(); ++y) {
+        const QRgb *row = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        uchar *outputRow = output + y * width;
+        for (int x = 0; x < width; ++x) {
+            if (qAlpha(row[x]) == 0) {
+                outputRow[x] = index;
+                found = true;
+            }
         }
     }
+    return found;
+}
 
-    int ColorMapSize = 255;
-    ColorMapObject cmap;
-    cmap.ColorCount = ColorMapSize;
-    cmap.BitsPerPixel = 8;
-    cmap.Colors = new GifColorType[ColorMapSize];
-    GifByteType *outputBuffer = new GifByteType[dim];
-    QuantizeBuffer(image.width(), image.height(), &ColorMapSize,
-                   rBuffer, gBuffer, bBuffer, outputBuffer, cmap.Colors);
+static int quantize(const QImage &image, uchar *output, GifColorType *colors)
+{
+    // One entry is left for the transparent color
+    int colorCount = 255;
+    const int bits = image.width() * image.height() >= GIF_LARGE_FRAME_PIXELS ? 5 : 7;
+    if (QuantizeRGB32Buffer(image.width(), image.height(), image.bytesPerLine(), bits, &colorCount,
+                            image.constBits(), output, colors) == GIF_ERROR) {
+        return -1;
+    }
+    for (int c = colorCount; c < 256; ++c) {
+        colors[c].Red = colors[c].Green = colors[c].Blue = 0;
+    }
+    return colorCount;
+}
 
-    QVector<QRgb> colorTable;
-    colorTable.reserve(256);
-    for (int i = 0; i < ColorMapSize; ++i) {
-        GifColorType color = cmap.Colors[i];
-        colorTable += qRgb(color.Red, color.Green, color.Blue);
+static void putGraphicsControl(GifFileType *gif, int disposal, int delay, int transparentIndex)
+{
+    // Delay is in hundredths of a second
+    char extension[] = {
+        char((disposal << 2) | (transparentIndex >= 0 ? 1 : 0)),
+        char(delay & 0xff), char((delay >> 8) & 0xff),
+        char(transparentIndex >= 0 ? transparentIndex : 0)
+    };
+    EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, 4, extension);
+}
+
+bool exportGif(const QImage &img, const QString &fileName)
+{
+    QFile file;
+    file.setFileName(fileName);
+    if (!file.open(QFile::WriteOnly)) {
+        return false;
     }
-    colorTable += qRgba(0, 0, 0, 0);
-    while (colorTable.count() < 256)
-        colorTable += qRgb(0, 0, 0);
 
-    delete [] outputBuffer;
-    delete [] rBuffer;
-    delete [] gBuffer;
-    delete [] bBuffer;
+    const QImage image = toRgb32(img);
+    const int width = image.width();
 
-    image = image.convertToFormat(QImage::Format_Indexed8, colorTable);
+    QByteArray indexed(width * image.height(), 0);
+    uchar *output = reinterpret_cast<uchar *>(indexed.data());
 
-    colorTable = image.colorTable();
+    ColorMapObject cmap;
+    GifColorType colors[256];
     cmap.ColorCount = 256;
     cmap.BitsPerPixel = 8;
-    int bgcolor = -1;
-    for (int c = 0; c < 256; ++c) {
-        cmap.Colors[c].Red = qRed(colorTable[c]);
-        cmap.Colors[c].Green = qGreen(colorTable[c]);
-        cmap.Colors[c].Blue = qBlue(colorTable[c]);
-        if (qAlpha(colorTable[c]) == 0)
-            bgcolor = c;
+    cmap.Colors = colors;
+    const int colorCount = quantize(image, output, colors);
+    if (colorCount < 0) {
+        return false;
     }
+    const int bgcolor = markTransparentPixels(image, output, colorCount) ? colorCount : -1;
+
     EGifSetGifVersion("87a");
 
     GifFileType *gif = EGifOpen(&file, saveGifBlock);
     gif->ImageCount = 1;
-    EGifPutScreenDesc(gif, image.width(), image.height(), 256, 0, &cmap);
+    EGifPutScreenDesc(gif, width, image.height(), 256, 0, &cmap);
     if (bgcolor >= 0) {
-        char extension[] = { 1, 0, 0, bgcolor };
-        EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, 4, extension);
+        putGraphicsControl(gif, 0, 0, bgcolor);
     }
-    EGifPutImageDesc(gif, 0, 0, image.width(), image.height(), 0, &cmap);
+    EGifPutImageDesc(gif, 0, 0, width, image.height(), 0, &cmap);
 
     for (int y = 0; y < image.height(); ++y) {
-        if (EGifPutLine(gif, (GifPixelType*)(image.scanLine(y)), img.width()) == GIF_ERROR) {
+        if (EGifPutLine(gif, (GifPixelType*)(output + y * width), width) == GIF_ERROR) {
             break;
         }
     }
@@ -120,7 +145,208 @@ bool exportGif(const QImage &img, const QString &fileName)
     EGifCloseFile(gif);
     file.close();
 
-    delete [] cmap.Colors;
+    return true;
+}
+
+GifWriter::GifWriter()
+    : m_gif(0)
+    , m_colorCount(0)
+    , m_frameCount(0)
+{
+}
+
+GifWriter::~GifWriter()
+{
+    close();
+}
+
+bool GifWriter::open(const QString &fileName)
+{
+    close();
 
+    m_file.setFileName(fileName);
+    return m_file.open(QFile::WriteOnly);
+}
+
+bool GifWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString GifWriter::fileName() const
+{
+    return m_file.fileName();
+}
+
+int GifWriter::frameCount() const
+{
+    return m_frameCount;
+}
+
+// Quantizes the palette out of the first frame and starts the file with it
+bool GifWriter::writeHeader(const QImage &image)
+{
+    m_size = image.size();
+    m_previousFrame = QByteArray(m_size.width() * m_size.height(), 0);
+    uchar *output = reinterpret_cast<uchar *>(m_previousFrame.data());
+
+    m_colorCount = quantize(image, output, m_colors);
+    if (m_colorCount < 0) {
+        return false;
+    }
+    markTransparentPixels(image, output, m_colorCount);
+    m_colorLookup.fill(-1, 1 << 15);
+
+    ColorMapObject cmap;
+    cmap.ColorCount = 256;
+    cmap.BitsPerPixel = 8;
+    cmap.Colors = m_colors;
+
+    EGifSetGifVersion("89a");
+    m_gif = EGifOpen(&m_file, saveGifBlock);
+    if (!m_gif || EGifPutScreenDesc(m_gif, m_size.width(), m_size.height(), 256, 0, &cmap) == GIF_ERROR) {
+        return false;
+    }
+
+    // Loop forever
+    char loop[] = { 1, 0, 0 };
+    char application[] = "NETSCAPE2.0";
+    EGifPutExtensionFirst(m_gif, APPLICATION_EXT_FUNC_CODE, 11, application);
+    EGifPutExtensionLast(m_gif, APPLICATION_EXT_FUNC_CODE, 3, loop);
     return true;
 }
+
+int GifWriter::closestColor(QRgb color) const
+{
+    int closest = 0;
+    int closestDistance = INT_MAX;
+    for (int c = 0; c < m_colorCount; ++c) {
+        const int dr = qRed(color) - m_colors[c].Red;
+        const int dg = qGreen(color) - m_colors[c].Green;
+        const int db = qBlue(color) - m_colors[c].Blue;
+        const int distance = dr * dr + dg * dg + db * db;
+        if (distance < closestDistance) {
+            closest = c;
+            closestDistance = distance;
+        }
+    }
+    return closest;
+}
+
+// Maps the frame onto the fixed palette through a lookup of 5 bits per primary color
+void GifWriter::mapToPalette(const QImage &image, uchar *output)
+{
+    short *lookup = m_colorLookup.data();
+    const int width = m_size.width();
+    for (int y = 0; y < m_size.height(); ++y) {
+        const QRgb *row = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        uchar *outputRow = output + y * width;
+        for (int x = 0; x < width; ++x) {
+            const QRgb pixel = row[x];
+            const int key = ((pixel >> 9) & 0x7c00) | ((pixel >> 6) & 0x03e0) | ((pixel >> 3) & 0x001f);
+            if (lookup[key] < 0) {
+                lookup[key] = closestColor(pixel);
+            }
+            outputRow[x] = lookup[key];
+        }
+    }
+    markTransparentPixels(image, output, m_colorCount);
+}
+
+bool GifWriter::addFrame(const QImage &img, int delay)
+{
+    if (!isOpen() || img.isNull()) {
+        return false;
+    }
+
+    QImage image = toRgb32(img);
+    int left = 0, top = 0, right = 0, bottom = 0;
+    QByteArray indexed;
+    const uchar *output;
+
+    if (!m_gif) {
+        if (!writeHeader(image)) {
+            return false;
+        }
+        output = reinterpret_cast<const uchar *>(m_previousFrame.constData());
+        right = m_size.width() - 1;
+        bottom = m_size.height() - 1;
+    } else {
+        // Frames are laid out on the screen of the first one
+        if (image.size() != m_size) {
+            image = image.copy(0, 0, m_size.width(), m_size.height());
+        }
+        indexed = QByteArray(m_size.width() * m_size.height(), 0);
+        uchar *data = reinterpret_cast<uchar *>(indexed.data());
+        mapToPalette(image, data);
+        output = data;
+
+        // Only encode the rectangle that changed since the previous frame
+        const int width = m_size.width();
+        const uchar *previous = reinterpret_cast<const uchar *>(m_previousFrame.constData());
+        top = 0;
+        while (top < m_size.height() && !memcmp(output + top * width, previous + top * width, width))
+            ++top;
+        if (top == m_size.height()) {
+            // Nothing changed: a single unchanged pixel still carries the delay
+            top = bottom = 0;
+        } else {
+            bottom = m_size.height() - 1;
+            while (bottom > top && !memcmp(output + bottom * width, previous + bottom * width, width))
+                --bottom;
+            left = width - 1;
+            for (int y = top; y <= bottom; ++y) {
+                const int offset = y * width;
+                int x = 0;
+                while (x < left && output[offset + x] == previous[offset + x])
+                    ++x;
+                left = x;
+                x = width - 1;
+                while (x > right && output[offset + x] == previous[offset + x])
+                    --x;
+                right = x;
+            }
+        }
+    }
+
+    const int transparentIndex = m_colorCount < 256 ? m_colorCount : -1;
+    putGraphicsControl(m_gif, 1, (qMax(delay, 0) + 5) / 10, transparentIndex);
+    const int width = right - left + 1;
+    if (EGifPutImageDesc(m_gif, left, top, width, bottom - top + 1, 0, NULL) == GIF_ERROR) {
+        return false;
+    }
+    for (int y = top; y <= bottom; ++y) {
+        if (EGifPutLine(m_gif, (GifPixelType*)(output + y * m_size.width() + left), width) == GIF_ERROR) {
+            return false;
+        }
+    }
+
+    if (!indexed.isNull()) {
+        m_previousFrame = indexed;
+    }
+    ++m_frameCount;
+    return true;
+}
+
+bool GifWriter::close()
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    bool ok = true;
+    if (m_gif) {
+        ok = EGifCloseFile(m_gif) != GIF_ERROR;
+        m_gif = 0;
+    } else {
+        // No frame was added, there is no image to leave behind
+        m_file.remove();
+        ok = false;
+    }
+    m_file.close();
+
+    m_previousFrame.clear();
+    m_colorLookup.clear();
+    m_frameCount = 0;
+    return ok;
+}
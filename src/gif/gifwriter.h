@@ -30,9 +30,51 @@
 #ifndef GIFWRITER_H
 #define GIFWRITER_H
 
+#include <QByteArray>
+#include <QFile>
 #include <QImage>
 #include <QString>
+#include <QVector>
+
+#include "gif_lib.h"
 
 bool exportGif(const QImage &image, const QString &fileName);
 
+/**
+ * Writes successive images as the frames of one looping animated GIF.
+ *
+ * The palette is quantized once out of the first frame and kept for the
+ * whole animation; later frames are mapped onto it and only the area that
+ * changed since the previous frame is encoded.
+ */
+class GifWriter
+{
+public:
+    GifWriter();
+    ~GifWriter();
+
+    bool open(const QString &fileName);
+    bool isOpen() const;
+    QString fileName() const;
+
+    bool addFrame(const QImage &image, int delay);
+    int frameCount() const;
+
+    bool close();
+
+private:
+    bool writeHeader(const QImage &image);
+    void mapToPalette(const QImage &image, uchar *output);
+    int closestColor(QRgb color) const;
+
+    QFile m_file;
+    GifFileType *m_gif;
+    QSize m_size;
+    GifColorType m_colors[256];
+    int m_colorCount;
+    QVector<short> m_colorLookup;
+    QByteArray m_previousFrame;
+    int m_frameCount;
+};
+
 #endif
@@ -43,6 +43,7 @@
 #endif /* __MSDOS__ */
 
 static int SortRGBAxis;
+static int PrimColorBits = BITS_PER_PRIM_COLOR;
 
 typedef struct QuantizedColorType {
     GifByteType RGB[3];
@@ -62,6 +63,11 @@ static int SubdivColorMap(NewColorMapType * NewColorSubdiv,
                           unsigned int ColorMapSize,
                           unsigned int *NewColorMapSize);
 static int SortCmpRtn(const VoidPtr Entry1, const VoidPtr Entry2);
+static QuantizedColorType *AllocColorArray(int BitsPerPrimColor);
+static int QuantizeColorArray(QuantizedColorType * ColorArrayEntries,
+                              long PixelCount,
+                              int *ColorMapSize,
+                              GifColorType * OutputColorMap);
 
 /******************************************************************************
  * Quantize high resolution image into lower one. Input image consists of a
@@ -85,27 +91,16 @@ QuantizeBuffer(unsigned int Width,
                GifByteType * OutputBuffer,
                GifColorType * OutputColorMap) {
 
-    unsigned int Index, NumOfEntries;
-    int i, j, MaxRGBError[3];
-    unsigned int NewColorMapSize;
-    long Red, Green, Blue;
-    NewColorMapType NewColorSubdiv[256];
-    QuantizedColorType *ColorArrayEntries, *QuantizedColor;
+    unsigned int Index;
+    int i;
+#ifdef DEBUG
+    int MaxRGBError[3];
+#endif /* DEBUG */
+    QuantizedColorType *ColorArrayEntries;
 
-    ColorArrayEntries = (QuantizedColorType *)malloc(
-                           sizeof(QuantizedColorType) * COLOR_ARRAY_SIZE);
-    if (ColorArrayEntries == NULL) {
-        _GifError = E_GIF_ERR_NOT_ENOUGH_MEM;
+    ColorArrayEntries = AllocColorArray(BITS_PER_PRIM_COLOR);
+    if (ColorArrayEntries == NULL)
         return GIF_ERROR;
-    }
-
-    for (i = 0; i < COLOR_ARRAY_SIZE; i++) {
-        ColorArrayEntries[i].RGB[0] = i >> (2 * BITS_PER_PRIM_COLOR);
-        ColorArrayEntries[i].RGB[1] = (i >> BITS_PER_PRIM_COLOR) &
-           MAX_PRIM_COLOR;
-        ColorArrayEntries[i].RGB[2] = i & MAX_PRIM_COLOR;
-        ColorArrayEntries[i].Count = 0;
-    }
 
     /* Sample the colors and their distribution: */
     for (i = 0; i < (int)(Width * Height); i++) {
@@ -117,6 +112,163 @@ QuantizeBuffer(unsigned int Width,
         ColorArrayEntries[Index].Count++;
     }
 
+    if (QuantizeColorArray(ColorArrayEntries, ((long)Width) * Height,
+                           ColorMapSize, OutputColorMap) != GIF_OK) {
+        free((char *)ColorArrayEntries);
+        return GIF_ERROR;
+    }
+
+    /* Finally scan the input buffer again and put the mapped index in the
+     * output buffer.  */
+#ifdef DEBUG
+    MaxRGBError[0] = MaxRGBError[1] = MaxRGBError[2] = 0;
+#endif /* DEBUG */
+    for (i = 0; i < (int)(Width * Height); i++) {
+        Index = ((RedInput[i] >> (8 - BITS_PER_PRIM_COLOR)) <<
+                 (2 * BITS_PER_PRIM_COLOR)) +
+                ((GreenInput[i] >> (8 - BITS_PER_PRIM_COLOR)) <<
+                 BITS_PER_PRIM_COLOR) +
+                (BlueInput[i] >> (8 - BITS_PER_PRIM_COLOR));
+        Index = ColorArrayEntries[Index].NewColorIndex;
+        OutputBuffer[i] = Index;
+#ifdef DEBUG
+        if (MaxRGBError[0] < ABS(OutputColorMap[Index].Red - RedInput[i]))
+            MaxRGBError[0] = ABS(OutputColorMap[Index].Red - RedInput[i]);
+        if (MaxRGBError[1] < ABS(OutputColorMap[Index].Green - GreenInput[i]))
+            MaxRGBError[1] = ABS(OutputColorMap[Index].Green - GreenInput[i]);
+        if (MaxRGBError[2] < ABS(OutputColorMap[Index].Blue - BlueInput[i]))
+            MaxRGBError[2] = ABS(OutputColorMap[Index].Blue - BlueInput[i]);
+#endif /* DEBUG */
+    }
+
+#ifdef DEBUG
+    fprintf(stderr,
+            "Quantization L(0) errors: Red = %d, Green = %d, Blue = %d.\n",
+            MaxRGBError[0], MaxRGBError[1], MaxRGBError[2]);
+#endif /* DEBUG */
+
+    free((char *)ColorArrayEntries);
+
+    return GIF_OK;
+}
+
+/******************************************************************************
+ * Same as QuantizeBuffer, but the input is a single buffer of 32 bits pixels
+ * (0xAARRGGBB in native byte order, alpha ignored) with BytesPerLine bytes
+ * per row, which is walked row by row without splitting it into channels.
+ *   BitsPerPrimColor (1 to 7) sets how many bits of each primary color are
+ * kept for the color histogram: fewer bits make a much smaller histogram to
+ * clear and sort, which pays off on large images at the cost of some
+ * precision.
+ ******************************************************************************/
+int
+QuantizeRGB32Buffer(unsigned int Width,
+                    unsigned int Height,
+                    unsigned int BytesPerLine,
+                    int BitsPerPrimColor,
+                    int *ColorMapSize,
+                    const GifByteType * Input,
+                    GifByteType * OutputBuffer,
+                    GifColorType * OutputColorMap) {
+
+    unsigned int x, y, Pixel, Mask;
+    const unsigned int *Row;
+    GifByteType *OutputRow;
+    QuantizedColorType *ColorArrayEntries;
+
+    if (BitsPerPrimColor < 1 || BitsPerPrimColor > BITS_PER_PRIM_COLOR)
+        BitsPerPrimColor = BITS_PER_PRIM_COLOR;
+    Mask = (1 << BitsPerPrimColor) - 1;
+
+#define RGB32_COLOR_INDEX(p) \
+    ((((p) >> (24 - BitsPerPrimColor) & Mask) << (2 * BitsPerPrimColor)) | \
+     (((p) >> (16 - BitsPerPrimColor) & Mask) << BitsPerPrimColor) | \
+     ((p) >> (8 - BitsPerPrimColor) & Mask))
+
+    ColorArrayEntries = AllocColorArray(BitsPerPrimColor);
+    if (ColorArrayEntries == NULL)
+        return GIF_ERROR;
+
+    /* Sample the colors and their distribution: */
+    for (y = 0; y < Height; y++) {
+        Row = (const unsigned int *)(Input + y * BytesPerLine);
+        for (x = 0; x < Width; x++) {
+            Pixel = Row[x];
+            ColorArrayEntries[RGB32_COLOR_INDEX(Pixel)].Count++;
+        }
+    }
+
+    if (QuantizeColorArray(ColorArrayEntries, ((long)Width) * Height,
+                           ColorMapSize, OutputColorMap) != GIF_OK) {
+        free((char *)ColorArrayEntries);
+        return GIF_ERROR;
+    }
+
+    /* Map the input to the output buffer (Width bytes per row): */
+    for (y = 0; y < Height; y++) {
+        Row = (const unsigned int *)(Input + y * BytesPerLine);
+        OutputRow = OutputBuffer + y * Width;
+        for (x = 0; x < Width; x++) {
+            Pixel = Row[x];
+            OutputRow[x] =
+               ColorArrayEntries[RGB32_COLOR_INDEX(Pixel)].NewColorIndex;
+        }
+    }
+
+#undef RGB32_COLOR_INDEX
+
+    free((char *)ColorArrayEntries);
+
+    return GIF_OK;
+}
+
+/******************************************************************************
+ * Allocate the color histogram for BitsPerPrimColor bits per primary color,
+ * with all the counts cleared. Returns NULL if out of memory.
+ ******************************************************************************/
+static QuantizedColorType *
+AllocColorArray(int BitsPerPrimColor) {
+
+    int i, Size = 1 << (3 * BitsPerPrimColor), Mask = (1 << BitsPerPrimColor) - 1;
+    QuantizedColorType *ColorArrayEntries;
+
+    ColorArrayEntries = (QuantizedColorType *)malloc(
+                           sizeof(QuantizedColorType) * Size);
+    if (ColorArrayEntries == NULL) {
+        _GifError = E_GIF_ERR_NOT_ENOUGH_MEM;
+        return NULL;
+    }
+
+    for (i = 0; i < Size; i++) {
+        ColorArrayEntries[i].RGB[0] = i >> (2 * BitsPerPrimColor);
+        ColorArrayEntries[i].RGB[1] = (i >> BitsPerPrimColor) & Mask;
+        ColorArrayEntries[i].RGB[2] = i & Mask;
+        ColorArrayEntries[i].Count = 0;
+    }
+
+    PrimColorBits = BitsPerPrimColor;
+
+    return ColorArrayEntries;
+}
+
+/******************************************************************************
+ * Build the output color map out of a color histogram made by
+ * AllocColorArray, and set the NewColorIndex of every sampled color.
+ * ColorMapSize is updated to the real size of the color map.
+ ******************************************************************************/
+static int
+QuantizeColorArray(QuantizedColorType * ColorArrayEntries,
+                   long PixelCount,
+                   int *ColorMapSize,
+                   GifColorType * OutputColorMap) {
+
+    unsigned int NumOfEntries;
+    int i, j, Size = 1 << (3 * PrimColorBits);
+    unsigned int NewColorMapSize;
+    long Red, Green, Blue;
+    NewColorMapType NewColorSubdiv[256];
+    QuantizedColorType *QuantizedColor;
+
     /* Put all the colors in the first entry of the color map, and call the
      * recursive subdivision process.  */
     for (i = 0; i < 256; i++) {
@@ -129,12 +281,17 @@ QuantizeBuffer(unsigned int Width,
     }
 
     /* Find the non empty entries in the color table and chain them: */
-    for (i = 0; i < COLOR_ARRAY_SIZE; i++)
+    for (i = 0; i < Size; i++)
         if (ColorArrayEntries[i].Count > 0)
             break;
+    if (i == Size) {
+        /* Empty image */
+        *ColorMapSize = 0;
+        return GIF_OK;
+    }
     QuantizedColor = NewColorSubdiv[0].QuantizedColors = &ColorArrayEntries[i];
     NumOfEntries = 1;
-    while (++i < COLOR_ARRAY_SIZE)
+    while (++i < Size)
         if (ColorArrayEntries[i].Count > 0) {
             QuantizedColor->Pnext = &ColorArrayEntries[i];
             QuantizedColor = &ColorArrayEntries[i];
@@ -143,11 +300,10 @@ QuantizeBuffer(unsigned int Width,
     QuantizedColor->Pnext = NULL;
 
     NewColorSubdiv[0].NumEntries = NumOfEntries; /* Different sampled colors */
-    NewColorSubdiv[0].Count = ((long)Width) * Height; /* Pixels */
+    NewColorSubdiv[0].Count = PixelCount; /* Pixels */
     NewColorMapSize = 1;
     if (SubdivColorMap(NewColorSubdiv, *ColorMapSize, &NewColorMapSize) !=
        GIF_OK) {
-        free((char *)ColorArrayEntries);
         return GIF_ERROR;
     }
     if (NewColorMapSize < *ColorMapSize) {
@@ -170,42 +326,15 @@ QuantizeBuffer(unsigned int Width,
                 Blue += QuantizedColor->RGB[2];
                 QuantizedColor = QuantizedColor->Pnext;
             }
-            OutputColorMap[i].Red = (Red << (8 - BITS_PER_PRIM_COLOR)) / j;
-            OutputColorMap[i].Green = (Green << (8 - BITS_PER_PRIM_COLOR)) / j;
-            OutputColorMap[i].Blue = (Blue << (8 - BITS_PER_PRIM_COLOR)) / j;
+            OutputColorMap[i].Red = (Red << (8 - PrimColorBits)) / j;
+            OutputColorMap[i].Green = (Green << (8 - PrimColorBits)) / j;
+            OutputColorMap[i].Blue = (Blue << (8 - PrimColorBits)) / j;
         } else
             fprintf(stderr,
                     "\n%s: Null entry in quantized color map - that's weird.\n",
                     PROGRAM_NAME);
     }
 
-    /* Finally scan the input buffer again and put the mapped index in the
-     * output buffer.  */
-    MaxRGBError[0] = MaxRGBError[1] = MaxRGBError[2] = 0;
-    for (i = 0; i < (int)(Width * Height); i++) {
-        Index = ((RedInput[i] >> (8 - BITS_PER_PRIM_COLOR)) <<
-                 (2 * BITS_PER_PRIM_COLOR)) +
-                ((GreenInput[i] >> (8 - BITS_PER_PRIM_COLOR)) <<
-                 BITS_PER_PRIM_COLOR) +
-                (BlueInput[i] >> (8 - BITS_PER_PRIM_COLOR));
-        Index = ColorArrayEntries[Index].NewColorIndex;
-        OutputBuffer[i] = Index;
-        if (MaxRGBError[0] < ABS(OutputColorMap[Index].Red - RedInput[i]))
-            MaxRGBError[0] = ABS(OutputColorMap[Index].Red - RedInput[i]);
-        if (MaxRGBError[1] < ABS(OutputColorMap[Index].Green - GreenInput[i]))
-            MaxRGBError[1] = ABS(OutputColorMap[Index].Green - GreenInput[i]);
-        if (MaxRGBError[2] < ABS(OutputColorMap[Index].Blue - BlueInput[i]))
-            MaxRGBError[2] = ABS(OutputColorMap[Index].Blue - BlueInput[i]);
-    }
-
-#ifdef DEBUG
-    fprintf(stderr,
-            "Quantization L(0) errors: Red = %d, Green = %d, Blue = %d.\n",
-            MaxRGBError[0], MaxRGBError[1], MaxRGBError[2]);
-#endif /* DEBUG */
-
-    free((char *)ColorArrayEntries);
-
     *ColorMapSize = NewColorMapSize;
 
     return GIF_OK;
@@ -286,8 +415,8 @@ SubdivColorMap(NewColorMapType * NewColorSubdiv,
          */
         MaxColor = QuantizedColor->RGB[SortRGBAxis]; /* Max. of first half */
         MinColor = QuantizedColor->Pnext->RGB[SortRGBAxis]; /* of second */
-        MaxColor <<= (8 - BITS_PER_PRIM_COLOR);
-        MinColor <<= (8 - BITS_PER_PRIM_COLOR);
+        MaxColor <<= (8 - PrimColorBits);
+        MinColor <<= (8 - PrimColorBits);
 
         /* Partition right here: */
         NewColorSubdiv[*NewColorMapSize].QuantizedColors =
@@ -0,0 +1,125 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "hostinfocache.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSet>
+#include <QWebSettings>
+
+#include "phantom.h"
+#include "config.h"
+
+// Exported by QtNetwork (see "qhostinfo.cpp")
+QT_BEGIN_NAMESPACE
+Q_NETWORK_EXPORT void qt_qhostinfo_set_cache_size(int entries);
+Q_NETWORK_EXPORT void qt_qhostinfo_set_cache_max_age(int seconds);
+Q_NETWORK_EXPORT void qt_qhostinfo_set_max_lookup_threads(int threads);
+Q_NETWORK_EXPORT QByteArray qt_qhostinfo_cache_snapshot();
+Q_NETWORK_EXPORT int qt_qhostinfo_restore_cache_snapshot(const QByteArray &snapshot);
+QT_END_NAMESPACE
+
+static HostInfoCache *hostinfocache_instance = 0;
+
+HostInfoCache *HostInfoCache::instance()
+{
+    if (!hostinfocache_instance)
+        hostinfocache_instance = new HostInfoCache();
+
+    return hostinfocache_instance;
+}
+
+HostInfoCache::HostInfoCache()
+    : QObject(QCoreApplication::instance())
+{
+    const Config *config = Phantom::instance()->config();
+
+    qt_qhostinfo_set_cache_size(config->dnsCacheSize());
+    qt_qhostinfo_set_cache_max_age(config->dnsCacheTtl());
+    qt_qhostinfo_set_max_lookup_threads(config->dnsLookupThreads());
+
+    // Resolve the hosts of the resources found by the HTML preload scanner
+    // (and of <link rel="dns-prefetch">) ahead of their requests
+    QWebSettings::globalSettings()->setAttribute(QWebSettings::DnsPrefetchEnabled, config->dnsPrefetchEnabled());
+
+    m_snapshotFile = config->dnsCacheFile();
+    load();
+}
+
+bool HostInfoCache::load()
+{
+    if (m_snapshotFile.isEmpty())
+        return false;
+
+    QFile file(m_snapshotFile);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    return qt_qhostinfo_restore_cache_snapshot(file.readAll()) > 0;
+}
+
+bool HostInfoCache::save() const
+{
+    if (m_snapshotFile.isEmpty())
+        return false;
+
+    // Write aside and rename, so concurrent processes never read half a snapshot
+    const QString temporaryName = QString("%1.%2").arg(m_snapshotFile).arg(QCoreApplication::applicationPid());
+    QFile file(temporaryName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+    const QByteArray data = qt_qhostinfo_cache_snapshot();
+    const bool written = file.write(data) == data.size();
+    file.close();
+
+    QFile::remove(m_snapshotFile);
+    if (!written || !QFile::rename(temporaryName, m_snapshotFile)) {
+        QFile::remove(temporaryName);
+        return false;
+    }
+    return true;
+}
+
+int HostInfoCache::prefetch(const QStringList &hosts)
+{
+    // The results land in the Qt cache, where the next requests find them
+    QSet<QString> unique;
+    foreach (const QString &host, hosts) {
+        const QString name = host.trimmed().toLower();
+        if (!name.isEmpty() && !unique.contains(name)) {
+            unique.insert(name);
+            QHostInfo::lookupHost(name, this, SLOT(lookedUp(QHostInfo)));
+        }
+    }
+    return unique.size();
+}
+
+void HostInfoCache::lookedUp(const QHostInfo &info)
+{
+    Q_UNUSED(info);
+}
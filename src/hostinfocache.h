@@ -0,0 +1,65 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef HOSTINFOCACHE_H
+#define HOSTINFOCACHE_H
+
+#include <QObject>
+#include <QHostInfo>
+#include <QStringList>
+
+/**
+ * Settings of the Qt host name lookup cache, shared by all the pages.
+ *
+ * The cache size, the time entries are reused and the number of parallel
+ * lookups come from the Config. With '--dns-cache-file' the cache is
+ * restored at startup and saved on exit, so a new process starts warm.
+ */
+class HostInfoCache: public QObject
+{
+    Q_OBJECT
+
+public:
+    static HostInfoCache *instance();
+
+    /// Writes the snapshot file, if any
+    bool save() const;
+
+    /// Starts resolving @p hosts in parallel; @return the number of lookups started
+    int prefetch(const QStringList &hosts);
+
+private slots:
+    void lookedUp(const QHostInfo &info);
+
+private:
+    HostInfoCache();
+    bool load();
+
+    QString m_snapshotFile;
+};
+
+#endif // HOSTINFOCACHE_H
@@ -62,6 +62,9 @@ Q_IMPORT_PLUGIN(qico)
 
 int main(int argc, char** argv, const char** envp)
 {
+    // Start the clock of "phantom.startupTimings"
+    Utils::markStartupPhase("main");
+
     // Setup Google Breakpad exception handler
 #ifdef Q_OS_LINUX
     google_breakpad::ExceptionHandler eh("/tmp", NULL, Utils::exceptionHandler, NULL, true);
@@ -89,8 +92,10 @@ int main(int argc, char** argv, const char** envp)
         free(szBuffer);
     }
 #endif
-   
+    Utils::markStartupPhase("breakpad");
+
     QCA::Initializer init;
+    Utils::markStartupPhase("qca");
     QApplication app(argc, argv);
 
     app.setWindowIcon(QIcon(":/phantomjs-icon.png"));
@@ -104,6 +109,7 @@ int main(int argc, char** argv, const char** envp)
 
     // Registering an alternative Message Handler
     qInstallMsgHandler(Utils::messageHandler);
+    Utils::markStartupPhase("application");
 
     // Get the Phantom singleton
     Phantom *phantom = Phantom::instance();
@@ -8,4 +8,15 @@ require.stub('fs', {
     }
 });
 
-module.exports = require('../coffee-script');
+var coffee = module.exports = require('../coffee-script');
+
+// Compile through the cache of '--compile-cache-path' (a no-op without it)
+require.extensions['.coffee'] = function(module, filename) {
+    var source = fs.read(filename),
+        compiled = phantom._findCompiledCoffeeScript(source);
+    if (!compiled) {
+        compiled = coffee.compile(source, { filename: filename });
+        phantom._storeCompiledCoffeeScript(source, compiled);
+    }
+    module._compile(compiled);
+};
@@ -0,0 +1,82 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/**
+ * Starts "command" with the array of "args", in the current working directory.
+ *
+ * The returned process has "onStdout(data)", "onStderr(data)" and "onExit(code)"
+ * handlers, a "pid" and a "kill()" function. The code is -1 if it crashed or
+ * was killed.
+ */
+exports.spawn = function (command, args) {
+    var process = phantom.createChildProcess(),
+        handlers = {};
+
+    function defineSetter(handlerName, signalName) {
+        process.__defineSetter__(handlerName, function (f) {
+            if (handlers && typeof handlers[signalName] === 'function') {
+                try {
+                    this[signalName].disconnect(handlers[signalName]);
+                } catch (e) {}
+            }
+            handlers[signalName] = f;
+            this[signalName].connect(handlers[signalName]);
+        });
+    }
+
+    defineSetter("onStdout", "stdoutData");
+    defineSetter("onStderr", "stderrData");
+    defineSetter("onExit", "exit");
+
+    // The output is only delivered once the script gives control back to the
+    // event loop, so handlers set right after spawn() miss nothing
+    if (!process.start(command, args || [])) {
+        throw "Unable to start '" + command + "'";
+    }
+    return process;
+};
+
+/**
+ * Runs "command" with the array of "args", and calls "callback(code, stdout, stderr)"
+ * with its whole output once it has exited.
+ */
+exports.execFile = function (command, args, callback) {
+    var process = exports.spawn(command, args),
+        stdout = "",
+        stderr = "";
+
+    process.onStdout = function (data) {
+        stdout += data;
+    };
+    process.onStderr = function (data) {
+        stderr += data;
+    };
+    process.onExit = function (code) {
+        callback(code, stdout, stderr);
+    };
+    return process;
+};
@@ -49,6 +49,67 @@ function isUndefinedOrNull(o) {
     return isUndefined(o) || null === o;
 }
 
+// How a page.evaluate argument reaches the page: "value" through the Qt
+// bridge, "json" as JSON parsed in the page (objects and arrays, as they always
+// were: key order kept, Infinity and NaN members become null) and "inline"
+// written into the source (NaN, functions, RegExp)
+function argumentPassing(o) {
+    if (checkType(o, 'number')) {
+        return o === o ? 'value' : 'inline';
+    }
+    if (isUndefined(o) || checkType(o, 'string') || checkType(o, 'boolean')) {
+        return 'value';
+    }
+    if (isObject(o) && !(o instanceof RegExp)) {
+        return 'json';
+    }
+    return 'inline';
+}
+
+// Source of a function calling func with args, and the values to call it
+// with, or null if an argument must be written inline. The source only
+// depends on func and on which arguments are JSON, so the page compiles it
+// once and func stays the same function across calls
+function passedArguments(func, args) {
+    var params = [], values = [], json = false, passing, i, l;
+    for (i = 0, l = args.length; i < l; i++) {
+        passing = argumentPassing(args[i]);
+        if (passing === 'inline') {
+            return null;
+        }
+        if (passing === 'json') {
+            json = true;
+            params.push('JSON.parse(arguments[' + i + '])');
+            values.push(JSON.stringify(args[i]));
+        } else {
+            params.push('arguments[' + i + ']');
+            values.push(args[i]);
+        }
+    }
+    if (!json) {
+        return { source: func.toString(), args: args };
+    }
+    return {
+        source: '(function(f) { return function() { return f.call(this, ' + params.join(', ') + '); }; })(' + func.toString() + ')',
+        args: values
+    };
+}
+
+// Source of a function calling func with args written inline, for arguments
+// the Qt bridge cannot carry
+function inlineArguments(func, args) {
+    var str = 'function() { return (' + func.toString() + ')(', arg, i, l;
+    for (i = 0, l = args.length; i < l; i++) {
+        arg = args[i];
+        if (/object|string/.test(typeof arg) && !(arg instanceof RegExp)) {
+            str += 'JSON.parse(' + JSON.stringify(JSON.stringify(arg)) + '),';
+        } else {
+            str += arg + ',';
+        }
+    }
+    return str.replace(/,$/, '') + '); }';
+}
+
 function copyInto(target, source) {
     if (target === source || isUndefinedOrNull(source)) {
         return target;
@@ -156,6 +217,8 @@ function decorateNewPage(opts, page) {
 
     definePageSignalSetter(page, handlers, "onResourceReceived", "resourceReceived");
 
+    definePageSignalSetter(page, handlers, "onNetworkIdle", "networkIdle");
+
     definePageSignalSetter(page, handlers, "onAlert", "javaScriptAlertSent");
 
     definePageSignalSetter(page, handlers, "onConsoleMessage", "javaScriptConsoleMessageSent");
@@ -238,21 +301,40 @@ function decorateNewPage(opts, page) {
      * @return  {*}                 the function call result
      */
     page.evaluate = function (func, args) {
-        var str, arg, i, l;
+        var call;
         if (!(func instanceof Function || typeof func === 'string' || func instanceof String)) {
             throw "Wrong use of WebPage#evaluate";
         }
-        str = 'function() { return (' + func.toString() + ')(';
-        for (i = 1, l = arguments.length; i < l; i++) {
-            arg = arguments[i];
-            if (/object|string/.test(typeof arg) && !(arg instanceof RegExp)) {
-                str += 'JSON.parse(' + JSON.stringify(JSON.stringify(arg)) + '),';
-            } else {
-                str += arg + ',';
-            }
+        args = Array.prototype.slice.call(arguments, 1);
+        call = passedArguments(func, args);
+        if (call) {
+            // Compiled once per frame, arguments are passed as values
+            return this._evaluateFunction(call.source, call.args);
+        }
+        return this.evaluateJavaScript(inlineArguments(func, args));
+    };
+
+    /**
+     * evaluate a function in the page, for large results: the result is
+     * cloned once into a compact buffer (dense arrays of numbers packed as
+     * doubles) and rebuilt directly as objects of this context.
+     * NOTE: like a structured clone, functions in the result become null
+     * and DOM objects plain objects of their own properties.
+     * @param   {function}  func    the function to evaluate
+     * @param   {...}       args    function arguments
+     * @return  {*}                 the function call result
+     */
+    page.evaluateBulk = function (func, args) {
+        var call;
+        if (!(func instanceof Function || typeof func === 'string' || func instanceof String)) {
+            throw "Wrong use of WebPage#evaluateBulk";
+        }
+        args = Array.prototype.slice.call(arguments, 1);
+        call = passedArguments(func, args);
+        if (call) {
+            return this._evaluateFunctionBulk(call.source, call.args);
         }
-        str = str.replace(/,$/, '') + '); }';
-        return this.evaluateJavaScript(str);
+        return this._evaluateFunctionBulk(inlineArguments(func, args), []);
     };
 
     /**
@@ -309,6 +391,15 @@ function decorateNewPage(opts, page) {
         this.setCookies(cookies);
     });
 
+    /**
+     * reset the page and hand it back to the pool used by "acquire()",
+     * the page must not be used afterwards
+     */
+    page.recycle = function () {
+        this.onPageCreated = undefined;
+        return phantom.recycleWebPage(this);
+    };
+
     // Copy options into page
     if (opts) {
         page = copyInto(page, opts);
@@ -753,3 +844,8 @@ function decorateNewPage(opts, page) {
 exports.create = function (opts) {
     return decorateNewPage(opts, phantom.createWebPage());
 };
+
+// Same as "create()", but reuses a page given back with "page.recycle()" if possible
+exports.acquire = function (opts) {
+    return decorateNewPage(opts, phantom.acquireWebPage());
+};
@@ -469,6 +469,15 @@ struct mg_connection {
   int buf_size;               // Buffer size
   int request_len;            // Size of the request + headers in a buffer
   int data_len;               // Total size of data in a buffer
+  int detached;               // One of the DETACH_* values below
+};
+
+// Life cycle of a connection taken over by mg_detach()
+enum {
+  DETACH_NONE,      // Owned by the worker thread
+  DETACH_PENDING,   // Detached, worker thread has not returned yet
+  DETACH_RELEASED,  // Detached, owned by the application
+  DETACH_CLOSED     // Closed by the application before worker returned
 };
 
 const char **mg_get_valid_option_names(void) {
@@ -3834,6 +3843,9 @@ static void process_new_connection(struct mg_connection *conn) {
         handle_proxy_request(conn);
       } else {
         handle_request(conn);
+        if (conn->detached != DETACH_NONE) {
+          return;
+        }
       }
       log_access(conn);
       discard_current_request_from_buffer(conn);
@@ -3876,14 +3888,61 @@ static int consume_socket(struct mg_context *ctx, struct socket *sp) {
   return 1;
 }
 
-static void worker_thread(struct mg_context *ctx) {
+static struct mg_connection *new_worker_connection(int buf_size) {
   struct mg_connection *conn;
-  int buf_size = atoi(ctx->config[MAX_REQUEST_SIZE]);
 
   conn = (struct mg_connection *) calloc(1, sizeof(*conn) + buf_size);
+  assert(conn != NULL);
   conn->buf_size = buf_size;
   conn->buf = (char *) (conn + 1);
-  assert(conn != NULL);
+
+  return conn;
+}
+
+static void free_detached_connection(struct mg_connection *conn) {
+  close_connection(conn);
+  if (conn->request_info.remote_user != NULL) {
+    free((void *) conn->request_info.remote_user);
+  }
+  free(conn);
+}
+
+void mg_detach(struct mg_connection *conn) {
+  conn->detached = DETACH_PENDING;
+}
+
+void mg_close_connection(struct mg_connection *conn) {
+  int released;
+
+  (void) pthread_mutex_lock(&conn->ctx->mutex);
+  released = conn->detached == DETACH_RELEASED;
+  conn->detached = DETACH_CLOSED;
+  (void) pthread_mutex_unlock(&conn->ctx->mutex);
+
+  // If the worker thread still runs the callback, it frees the connection
+  if (released) {
+    free_detached_connection(conn);
+  }
+}
+
+// Hand a detached connection over to the application. Return 1 if the
+// application has already closed it, in which case the worker frees it.
+static int release_detached_connection(struct mg_connection *conn) {
+  int closed;
+
+  (void) pthread_mutex_lock(&conn->ctx->mutex);
+  closed = conn->detached == DETACH_CLOSED;
+  conn->detached = DETACH_RELEASED;
+  (void) pthread_mutex_unlock(&conn->ctx->mutex);
+
+  return closed;
+}
+
+static void worker_thread(struct mg_context *ctx) {
+  struct mg_connection *conn;
+  int buf_size = atoi(ctx->config[MAX_REQUEST_SIZE]);
+
+  conn = new_worker_connection(buf_size);
 
   while (ctx->stop_flag == 0 && consume_socket(ctx, &conn->client)) {
     conn->birth_time = time(NULL);
@@ -3903,7 +3962,15 @@ static void worker_thread(struct mg_context *ctx) {
       process_new_connection(conn);
     }
 
-    close_connection(conn);
+    if (conn->detached != DETACH_NONE) {
+      // The application owns the connection now, continue with a fresh one
+      if (release_detached_connection(conn)) {
+        free_detached_connection(conn);
+      }
+      conn = new_worker_connection(buf_size);
+    } else {
+      close_connection(conn);
+    }
   }
   free(conn);
 
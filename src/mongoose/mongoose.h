@@ -160,6 +160,21 @@ int mg_printf(struct mg_connection *, const char *fmt, ...);
 int mg_read(struct mg_connection *, void *buf, size_t len);
 
 
+// Take over a connection from within the MG_NEW_REQUEST callback.
+//
+// Once the callback returns, the worker thread goes back to the pool without
+// closing the socket, and the connection stays valid until the application
+// calls mg_close_connection(). Keep-alive is not supported on detached
+// connections. All detached connections must be closed before mg_stop().
+void mg_detach(struct mg_connection *);
+
+
+// Close a connection previously handed over by mg_detach().
+//
+// Safe to call from any thread, even before the callback has returned.
+void mg_close_connection(struct mg_connection *);
+
+
 // Get the value of particular HTTP header.
 //
 // This is a helper function. It traverses request_info->http_headers array,
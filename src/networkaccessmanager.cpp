@@ -31,8 +31,7 @@
 
 #include <QAuthenticator>
 #include <QDateTime>
-#include <QDesktopServices>
-#include <QNetworkDiskCache>
+#include <QElapsedTimer>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QSslError>
@@ -45,8 +44,13 @@
 #include "config.h"
 #include "cookiejar.h"
 #include "networkaccessmanager.h"
+#include "networkdiskcache.h"
+#include "webpage.h"
 #include "terminal.h"
 
+// The rules of the '--url-blocklist' file, shared by all the pages
+Q_GLOBAL_STATIC(UrlBlocklist, globalBlocklist)
+
 static const char *toString(QNetworkAccessManager::Operation op)
 {
     const char *str = 0;
@@ -73,21 +77,107 @@ static const char *toString(QNetworkAccessManager::Operation op)
     return str;
 }
 
+// Monotonic time, in microseconds, since the first call: unlike "time"
+// it does not jump when the wall clock is changed
+static qint64 monotonicTimestamp()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock.nsecsElapsed() / 1000;
+}
+
+// Headers of a QNetworkRequest or QNetworkReply, as a list of {name, value}
+template <typename T>
+static QVariantList headersToList(const T &message)
+{
+    QVariantList headers;
+    foreach (QByteArray headerName, message.rawHeaderList()) {
+        QVariantMap header;
+        header["name"] = QString::fromUtf8(headerName);
+        header["value"] = QString::fromUtf8(message.rawHeader(headerName));
+        headers += header;
+    }
+    return headers;
+}
+
+// Value for a host in a per-host table: "cdn.company.com", then
+// ".cdn.company.com", ".company.com" and ".com", else the fallback
+static int valueForHost(const QHash<QString, int> &values, const QString &host, int fallback)
+{
+    if (values.isEmpty()) {
+        return fallback;
+    }
+
+    const QString name = host.toLower();
+    if (values.contains(name)) {
+        return values.value(name);
+    }
+    if (values.contains('.' + name)) {
+        return values.value('.' + name);
+    }
+    int dot = 0;
+    while ((dot = name.indexOf('.', dot)) != -1) {
+        const QString suffix = name.mid(dot);
+        if (values.contains(suffix)) {
+            return values.value(suffix);
+        }
+        ++dot;
+    }
+    return fallback;
+}
+
+// Per-host table of the positive values of a settings map
+static QHash<QString, int> hostTable(const QVariantMap &values)
+{
+    QHash<QString, int> table;
+    QVariantMap::const_iterator i = values.begin();
+    while (i != values.end()) {
+        const int value = i.value().toInt();
+        if (value > 0) {
+            table[i.key().toLower()] = value;
+        }
+        ++i;
+    }
+    return table;
+}
+
 // public:
 NetworkAccessManager::NetworkAccessManager(QObject *parent, const Config *config)
     : QNetworkAccessManager(parent)
     , m_ignoreSslErrors(config->ignoreSslErrors())
     , m_idCounter(0)
     , m_networkDiskCache(0)
+    , m_page(qobject_cast<WebPage *>(parent))
+    , m_maxConnectionsPerHost(config->maxConnectionsPerHost())
+    , m_httpPipelining(config->httpPipeliningEnabled())
+    , m_httpPipelineLength(config->httpPipelineLength())
+    , m_idleQuietMs(-1)
+    , m_idleMaxInflight(0)
+    , m_resourceTimeout(0)
 {
+    setHostConnections(config->hostConnections());
+
+    m_idleTimer.setSingleShot(true);
+    connect(&m_idleTimer, SIGNAL(timeout()), SLOT(handleIdleTimeout()));
+
+    static bool globalBlocklistLoaded = false;
+    if (!globalBlocklistLoaded) {
+        globalBlocklistLoaded = true;
+        if (!config->urlBlocklistFile().isEmpty() && !globalBlocklist()->load(config->urlBlocklistFile())) {
+            Terminal::instance()->cerr("Unable to open URL blocklist file: \"" + config->urlBlocklistFile() + "\"");
+        }
+    }
+
     setCookieJar(CookieJar::instance());
 
     if (config->diskCacheEnabled()) {
-        m_networkDiskCache = new QNetworkDiskCache(this);
-        m_networkDiskCache->setCacheDirectory(QDesktopServices::storageLocation(QDesktopServices::CacheLocation));
-        if (config->maxDiskCacheSize() >= 0)
-            m_networkDiskCache->setMaximumCacheSize(config->maxDiskCacheSize() * 1024);
+        m_networkDiskCache = NetworkDiskCache::instance(config);
         setCache(m_networkDiskCache);
+        // The disk cache is shared by all the pages: "setCache" took ownership of it,
+        // so give it back to the PhantomJS Singleton object (as for the CookieJar)
+        m_networkDiskCache->setParent(Phantom::instance());
     }
 
     m_sslConfiguration = QSslConfiguration::defaultConfiguration();
@@ -155,6 +245,16 @@ QVariantMap NetworkAccessManager::customHeaders() const
     return m_customHeaders;
 }
 
+void NetworkAccessManager::setResourceEventFields(const QStringList &fields)
+{
+    m_resourceEventFields = QSet<QString>::fromList(fields);
+}
+
+QStringList NetworkAccessManager::resourceEventFields() const
+{
+    return m_resourceEventFields.toList();
+}
+
 void NetworkAccessManager::setCookieJar(QNetworkCookieJar *cookieJar)
 {
     QNetworkAccessManager::setCookieJar(cookieJar);
@@ -165,9 +265,76 @@ void NetworkAccessManager::setCookieJar(QNetworkCookieJar *cookieJar)
     cookieJar->setParent(Phantom::instance());
 }
 
+void NetworkAccessManager::setMaxConnectionsPerHost(int count)
+{
+    m_maxConnectionsPerHost = count;
+}
+
+void NetworkAccessManager::setHostConnections(const QVariantMap &counts)
+{
+    m_hostConnections = hostTable(counts);
+}
+
+int NetworkAccessManager::connectionsForHost(const QString &host) const
+{
+    return valueForHost(m_hostConnections, host, m_maxConnectionsPerHost);
+}
+
+void NetworkAccessManager::setHttpPipelining(bool enabled, int length)
+{
+    m_httpPipelining = enabled;
+    m_httpPipelineLength = length;
+}
+
+void NetworkAccessManager::setBlockedUrls(const QStringList &rules)
+{
+    m_blocklist.setRules(rules);
+}
+
+QStringList NetworkAccessManager::blockedUrls() const
+{
+    return m_blocklist.rules();
+}
+
+void NetworkAccessManager::setResourceTimeout(int timeoutMs)
+{
+    m_resourceTimeout = qMax(timeoutMs, 0);
+}
+
+void NetworkAccessManager::setHostResourceTimeouts(const QVariantMap &timeouts)
+{
+    m_hostResourceTimeouts = hostTable(timeouts);
+}
+
+int NetworkAccessManager::resourceTimeoutForHost(const QString &host) const
+{
+    return valueForHost(m_hostResourceTimeouts, host, m_resourceTimeout);
+}
+
+QVariantMap NetworkAccessManager::activity() const
+{
+    QVariantMap activity;
+    activity["inflight"] = m_ids.size();
+    activity["receiving"] = m_started.size();
+    activity["requested"] = m_idCounter;
+    return activity;
+}
+
+void NetworkAccessManager::watchNetworkIdle(int quietMs, int maxInflight)
+{
+    m_idleQuietMs = quietMs;
+    m_idleMaxInflight = qMax(maxInflight, 0);
+    updateIdleTimer();
+}
+
 // protected:
 QNetworkReply *NetworkAccessManager::createRequest(Operation op, const QNetworkRequest & request, QIODevice * outgoingData)
 {
+    // Blocked requests never reach the network, nor the resource events
+    if (m_blocklist.matches(request.url()) || globalBlocklist()->matches(request.url())) {
+        return new BlockedNetworkReply(op, request, this);
+    }
+
     QNetworkRequest req(request);
 
     if (!QSslSocket::supportsSsl()) {
@@ -197,33 +364,57 @@ QNetworkReply *NetworkAccessManager::createRequest(Operation op, const QNetworkR
     // set SSL configuration
     req.setSslConfiguration(m_sslConfiguration);
 
+    // set connection concurrency and pipelining
+    const int connections = connectionsForHost(req.url().host());
+    if (connections > 0) {
+        req.setAttribute(QNetworkRequest::HttpConnectionCountAttribute, connections);
+    }
+    if (m_httpPipelining) {
+        req.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+        if (m_httpPipelineLength > 0) {
+            req.setAttribute(QNetworkRequest::HttpPipelineLengthAttribute, m_httpPipelineLength);
+        }
+    }
+
     // Pass duty to the superclass - Nothing special to do here (yet?)
     QNetworkReply *reply = QNetworkAccessManager::createRequest(op, req, outgoingData);
     if(m_ignoreSslErrors) {
         reply->ignoreSslErrors();
     }
 
-    QVariantList headers;
-    foreach (QByteArray headerName, req.rawHeaderList()) {
-        QVariantMap header;
-        header["name"] = QString::fromUtf8(headerName);
-        header["value"] = QString::fromUtf8(req.rawHeader(headerName));
-        headers += header;
-    }
-
     m_idCounter++;
     m_ids[reply] = m_idCounter;
-
-    QVariantMap data;
-    data["id"] = m_idCounter;
-    data["url"] = url.data();
-    data["method"] = toString(op);
-    data["headers"] = headers;
-    data["time"] = QDateTime::currentDateTime();
+    updateIdleTimer();
 
     connect(reply, SIGNAL(readyRead()), this, SLOT(handleStarted()));
 
-    emit resourceRequested(data);
+    // Owned by the reply, so it goes away with it
+    const int timeout = resourceTimeoutForHost(req.url().host());
+    if (timeout > 0) {
+        QTimer *timer = new QTimer(reply);
+        timer->setSingleShot(true);
+        timer->setProperty("timeout", timeout);
+        connect(timer, SIGNAL(timeout()), SLOT(handleResourceTimeout()));
+        timer->start(timeout);
+    }
+
+    // Don't build the event if nobody is going to receive it
+    if (!m_page || m_page->hasResourceRequestedHandlers()) {
+        QVariantMap data;
+        data["id"] = m_idCounter;
+        if (wantsField("url"))
+            data["url"] = url.data();
+        if (wantsField("method"))
+            data["method"] = toString(op);
+        if (wantsField("headers"))
+            data["headers"] = headersToList(req);
+        if (wantsField("time"))
+            data["time"] = QDateTime::currentDateTime();
+        if (wantsField("timestamp"))
+            data["timestamp"] = monotonicTimestamp();
+
+        emit resourceRequested(data);
+    }
     return reply;
 }
 
@@ -237,56 +428,106 @@ void NetworkAccessManager::handleStarted()
 
     m_started += reply;
 
-    QVariantList headers;
-    foreach (QByteArray headerName, reply->rawHeaderList()) {
-        QVariantMap header;
-        header["name"] = QString::fromUtf8(headerName);
-        header["value"] = QString::fromUtf8(reply->rawHeader(headerName));
-        headers += header;
-    }
+    if (m_page && !m_page->hasResourceReceivedHandlers())
+        return;
 
     QVariantMap data;
     data["stage"] = "start";
     data["id"] = m_ids.value(reply);
-    data["url"] = reply->url().toEncoded().data();
-    data["status"] = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
-    data["statusText"] = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute);
-    data["contentType"] = reply->header(QNetworkRequest::ContentTypeHeader);
-    data["bodySize"] = reply->size();
-    data["redirectURL"] = reply->header(QNetworkRequest::LocationHeader);
-    data["headers"] = headers;
-    data["time"] = QDateTime::currentDateTime();
+    if (wantsField("url"))
+        data["url"] = reply->url().toEncoded().data();
+    if (wantsField("status"))
+        data["status"] = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if (wantsField("statusText"))
+        data["statusText"] = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute);
+    if (wantsField("contentType"))
+        data["contentType"] = reply->header(QNetworkRequest::ContentTypeHeader);
+    if (wantsField("bodySize"))
+        data["bodySize"] = reply->size();
+    if (wantsField("redirectURL"))
+        data["redirectURL"] = reply->header(QNetworkRequest::LocationHeader);
+    if (wantsField("headers"))
+        data["headers"] = headersToList(*reply);
+    if (wantsField("time"))
+        data["time"] = QDateTime::currentDateTime();
+    if (wantsField("timestamp"))
+        data["timestamp"] = monotonicTimestamp();
 
     emit resourceReceived(data);
 }
 
 void NetworkAccessManager::handleFinished(QNetworkReply *reply)
 {
-    QVariantList headers;
-    foreach (QByteArray headerName, reply->rawHeaderList()) {
-        QVariantMap header;
-        header["name"] = QString::fromUtf8(headerName);
-        header["value"] = QString::fromUtf8(reply->rawHeader(headerName));
-        headers += header;
-    }
-
-    QVariantMap data;
-    data["stage"] = "end";
-    data["id"] = m_ids.value(reply);
-    data["url"] = reply->url().toEncoded().data();
-    data["status"] = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
-    data["statusText"] = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute);
-    data["contentType"] = reply->header(QNetworkRequest::ContentTypeHeader);
-    data["redirectURL"] = reply->header(QNetworkRequest::LocationHeader);
-    data["headers"] = headers;
-    data["time"] = QDateTime::currentDateTime();
+    // Blocked replies were never announced, so they get no "end" either
+    if (!m_ids.contains(reply))
+        return;
 
+    const int id = m_ids.value(reply);
     m_ids.remove(reply);
     m_started.remove(reply);
+    updateIdleTimer();
+
+    if (m_page && !m_page->hasResourceReceivedHandlers())
+        return;
+
+    QVariantMap data;
+    data["stage"] = "end";
+    data["id"] = id;
+    if (wantsField("url"))
+        data["url"] = reply->url().toEncoded().data();
+    if (wantsField("status"))
+        data["status"] = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if (wantsField("statusText"))
+        data["statusText"] = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute);
+    if (wantsField("contentType"))
+        data["contentType"] = reply->header(QNetworkRequest::ContentTypeHeader);
+    if (wantsField("redirectURL"))
+        data["redirectURL"] = reply->header(QNetworkRequest::LocationHeader);
+    if (wantsField("headers"))
+        data["headers"] = headersToList(*reply);
+    if (wantsField("time"))
+        data["time"] = QDateTime::currentDateTime();
+    if (wantsField("timestamp"))
+        data["timestamp"] = monotonicTimestamp();
+
+    // Duration of each phase of the request (in microseconds), not available for cached resources
+    if (wantsField("timings")) {
+        QVariant timings = reply->attribute(QNetworkRequest::HttpTimingsAttribute);
+        if (timings.isValid()) {
+            data["timings"] = timings;
+        }
+    }
 
     emit resourceReceived(data);
 }
 
+void NetworkAccessManager::handleResourceTimeout()
+{
+    QTimer *timer = qobject_cast<QTimer*>(sender());
+    QNetworkReply *reply = timer ? qobject_cast<QNetworkReply*>(timer->parent()) : 0;
+    if (!reply || !m_ids.contains(reply) || reply->isFinished())
+        return;
+
+    // Reported before the abort, so that it comes ahead of the "end" stage
+    if (!m_page || m_page->hasResourceReceivedHandlers()) {
+        QVariantMap data;
+        data["stage"] = "timeout";
+        data["id"] = m_ids.value(reply);
+        if (wantsField("url"))
+            data["url"] = reply->url().toEncoded().data();
+        if (wantsField("timeout"))
+            data["timeout"] = timer->property("timeout");
+        if (wantsField("time"))
+            data["time"] = QDateTime::currentDateTime();
+        if (wantsField("timestamp"))
+            data["timestamp"] = monotonicTimestamp();
+
+        emit resourceReceived(data);
+    }
+
+    reply->abort();
+}
+
 void NetworkAccessManager::provideAuthentication(QNetworkReply *reply, QAuthenticator *authenticator)
 {
     Q_UNUSED(reply);
@@ -297,6 +538,9 @@ void NetworkAccessManager::provideAuthentication(QNetworkReply *reply, QAuthenti
 // [euem] emits ssl errors when encountered
 void NetworkAccessManager::handleSslErrors(QNetworkReply* reply, const QList<QSslError> &errors)
 {
+    if (m_page && !m_page->hasResourceReceivedHandlers())
+        return;
+
     QVariantList sslErrors;
     foreach (QSslError e, errors)
     {
@@ -306,10 +550,77 @@ void NetworkAccessManager::handleSslErrors(QNetworkReply* reply, const QList<QSs
     QVariantMap data;
     data["stage"] = "ssl_error";
     data["id"] = m_ids.value(reply);
-    data["url"] = reply->url().toEncoded().data();
-    data["time"] = QDateTime::currentDateTime();
+    if (wantsField("url"))
+        data["url"] = reply->url().toEncoded().data();
+    if (wantsField("time"))
+        data["time"] = QDateTime::currentDateTime();
+    if (wantsField("timestamp"))
+        data["timestamp"] = monotonicTimestamp();
     data["errors"] = sslErrors;
 
     emit resourceReceived(data);
 }
 
+void NetworkAccessManager::handleIdleTimeout()
+{
+    const int quietMs = m_idleQuietMs;
+    m_idleQuietMs = -1;
+    emit networkIdle(quietMs, m_idleMaxInflight);
+}
+
+// private:
+bool NetworkAccessManager::wantsField(const char *field) const
+{
+    return m_resourceEventFields.isEmpty() || m_resourceEventFields.contains(QLatin1String(field));
+}
+
+// Any change of the requests in flight restarts the quiet period
+void NetworkAccessManager::updateIdleTimer()
+{
+    if (m_idleQuietMs < 0 || m_ids.size() > m_idleMaxInflight) {
+        m_idleTimer.stop();
+        return;
+    }
+    m_idleTimer.start(m_idleQuietMs);
+}
+
+BlockedNetworkReply::BlockedNetworkReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
+    : QNetworkReply(parent)
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(op);
+    setError(QNetworkReply::OperationCanceledError, "Blocked by the URL blocklist");
+    open(QIODevice::ReadOnly);
+
+    // Signals can only be emitted once the caller connected to them
+    QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection);
+}
+
+void BlockedNetworkReply::abort()
+{
+}
+
+qint64 BlockedNetworkReply::bytesAvailable() const
+{
+    return 0;
+}
+
+bool BlockedNetworkReply::isSequential() const
+{
+    return true;
+}
+
+qint64 BlockedNetworkReply::readData(char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+void BlockedNetworkReply::finish()
+{
+    setFinished(true);
+    emit error(QNetworkReply::OperationCanceledError);
+    emit finished();
+}
@@ -37,9 +37,32 @@
 #include <QNetworkReply>
 #include <QSet>
 #include <QSslConfiguration>
+#include <QStringList>
+#include <QTimer>
+
+#include "urlblocklist.h"
 
 class Config;
-class QNetworkDiskCache;
+class NetworkDiskCache;
+class WebPage;
+
+// Reply to a request matching the URL blocklist: fails without touching the network
+class BlockedNetworkReply : public QNetworkReply
+{
+    Q_OBJECT
+public:
+    BlockedNetworkReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
+
+    void abort();
+    qint64 bytesAvailable() const;
+    bool isSequential() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+
+private slots:
+    void finish();
+};
 
 class NetworkAccessManager : public QNetworkAccessManager
 {
@@ -51,8 +74,55 @@ public:
     void setCustomHeaders(const QVariantMap &headers);
     QVariantMap customHeaders() const;
 
+    /**
+     * Only these fields (plus "id" and "stage") are put in the resource events;
+     * all of them if empty.
+     */
+    void setResourceEventFields(const QStringList &fields);
+    QStringList resourceEventFields() const;
+
     void setCookieJar(QNetworkCookieJar *cookieJar);
 
+    /**
+     * Parallel connections opened to each host (0 for the Qt default),
+     * and per-host overrides: a key starting with '.' matches the subdomains too.
+     */
+    void setMaxConnectionsPerHost(int count);
+    void setHostConnections(const QVariantMap &counts);
+    int connectionsForHost(const QString &host) const;
+
+    /**
+     * Requests to URLs matching these rules (see UrlBlocklist), or the ones of
+     * the '--url-blocklist' file, fail right away.
+     */
+    void setBlockedUrls(const QStringList &rules);
+    QStringList blockedUrls() const;
+
+    /// Pipelines idempotent requests, up to @p length per connection (0 for the Qt default)
+    void setHttpPipelining(bool enabled, int length = 0);
+
+    /**
+     * Milliseconds a request may take before it is aborted, with a "timeout"
+     * resource event (0 for no limit), and per-host overrides matched as for
+     * setHostConnections().
+     */
+    void setResourceTimeout(int timeoutMs);
+    void setHostResourceTimeouts(const QVariantMap &timeouts);
+    int resourceTimeoutForHost(const QString &host) const;
+
+    /**
+     * Requests not finished yet ("inflight"), those of them already receiving
+     * data ("receiving"), and all the requests made so far ("requested").
+     */
+    QVariantMap activity() const;
+
+    /**
+     * Emits networkIdle() once, as soon as at most @p maxInflight requests
+     * have been in flight for @p quietMs without change. A negative
+     * @p quietMs cancels the previous call.
+     */
+    void watchNetworkIdle(int quietMs, int maxInflight);
+
 protected:
     bool m_ignoreSslErrors;
     QString m_userName;
@@ -62,20 +132,38 @@ protected:
 signals:
     void resourceRequested(const QVariant& data);
     void resourceReceived(const QVariant& data);
+    void networkIdle(int quietMs, int maxInflight);
 
 private slots:
     void handleStarted();
     void handleFinished(QNetworkReply *reply);
     void provideAuthentication(QNetworkReply *reply, QAuthenticator *authenticator);
     void handleSslErrors(QNetworkReply* reply, const QList<QSslError> &errors);
+    void handleIdleTimeout();
+    void handleResourceTimeout();
 
 private:
+    bool wantsField(const char *field) const;
+    void updateIdleTimer();
+
     QHash<QNetworkReply*, int> m_ids;
     QSet<QNetworkReply*> m_started;
     int m_idCounter;
-    QNetworkDiskCache* m_networkDiskCache;
+    NetworkDiskCache* m_networkDiskCache;
     QVariantMap m_customHeaders;
     QSslConfiguration m_sslConfiguration;
+    WebPage *m_page;
+    QSet<QString> m_resourceEventFields;
+    int m_maxConnectionsPerHost;
+    QHash<QString, int> m_hostConnections;
+    bool m_httpPipelining;
+    int m_httpPipelineLength;
+    UrlBlocklist m_blocklist;
+    QTimer m_idleTimer;
+    int m_idleQuietMs;
+    int m_idleMaxInflight;
+    int m_resourceTimeout;
+    QHash<QString, int> m_hostResourceTimeouts;
 };
 
 #endif // NETWORKACCESSMANAGER_H
@@ -0,0 +1,274 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "networkdiskcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDesktopServices>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiMap>
+
+#include "phantom.h"
+#include "config.h"
+
+// These must match the on-disk layout of QNetworkDiskCache in the bundled Qt
+#define CACHE_DATA_DIR      "data7/"
+#define CACHE_POSTFIX       ".d"
+
+// private:
+NetworkDiskCache::NetworkDiskCache(const Config *config, QObject *parent)
+    : QNetworkDiskCache(parent)
+    , m_totalSize(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+    setCacheDirectory(QDesktopServices::storageLocation(QDesktopServices::CacheLocation));
+    m_dataDirectory = cacheDirectory() + CACHE_DATA_DIR;
+    if (config->maxDiskCacheSize() >= 0)
+        setMaximumCacheSize(config->maxDiskCacheSize() * 1024);
+
+    loadIndex();
+    expire();
+}
+
+// public:
+NetworkDiskCache *NetworkDiskCache::instance(const Config *config)
+{
+    static NetworkDiskCache *singleton = NULL;
+    if (!singleton) {
+        // Create singleton and assign ownership to the Phantom singleton object
+        singleton = new NetworkDiskCache(config, Phantom::instance());
+    }
+    return singleton;
+}
+
+QVariantMap NetworkDiskCache::statistics() const
+{
+    QVariantMap statistics;
+    statistics["entries"] = m_index.size();
+    statistics["size"] = m_totalSize;
+    statistics["maximumSize"] = maximumCacheSize();
+    statistics["hits"] = m_hits;
+    statistics["misses"] = m_misses;
+    return statistics;
+}
+
+qint64 NetworkDiskCache::cacheSize() const
+{
+    return m_totalSize;
+}
+
+QNetworkCacheMetaData NetworkDiskCache::metaData(const QUrl &url)
+{
+    const QString key = entryKey(url);
+    QHash<QString, Entry>::iterator it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return QNetworkCacheMetaData();
+    }
+
+    // Entries found on disk at startup have their metadata read on first use
+    if (!it->metaData.isValid()) {
+        it->metaData = QNetworkDiskCache::metaData(url);
+        if (!it->metaData.isValid()) {
+            removeEntry(key);
+            ++m_misses;
+            return QNetworkCacheMetaData();
+        }
+    }
+
+    ++m_hits;
+    it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    return it->metaData;
+}
+
+QIODevice *NetworkDiskCache::data(const QUrl &url)
+{
+    const QString key = entryKey(url);
+    QHash<QString, Entry>::iterator it = m_index.find(key);
+    if (it == m_index.end()) {
+        return NULL;
+    }
+
+    QIODevice *device = QNetworkDiskCache::data(url);
+    if (!device) {
+        removeEntry(key);
+        return NULL;
+    }
+
+    it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    return device;
+}
+
+bool NetworkDiskCache::remove(const QUrl &url)
+{
+    bool removed = QNetworkDiskCache::remove(url);
+    removeEntry(entryKey(url));
+
+    // An insert of this URL in progress is abandoned: insert() will not come
+    QHash<QIODevice *, QNetworkCacheMetaData>::iterator it = m_inserting.begin();
+    while (it != m_inserting.end()) {
+        if (it->url() == url) {
+            it = m_inserting.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+QIODevice *NetworkDiskCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+    QIODevice *device = QNetworkDiskCache::prepare(metaData);
+    if (device) {
+        m_inserting.insert(device, metaData);
+        // Devices of inserts that are given up are destroyed without insert()
+        connect(device, SIGNAL(destroyed(QObject*)), this, SLOT(deviceDestroyed(QObject*)));
+    }
+    return device;
+}
+
+void NetworkDiskCache::insert(QIODevice *device)
+{
+    QNetworkCacheMetaData metaData = m_inserting.take(device);
+    disconnect(device, SIGNAL(destroyed(QObject*)), this, SLOT(deviceDestroyed(QObject*)));
+    QNetworkDiskCache::insert(device);
+
+    if (!metaData.isValid()) {
+        return;
+    }
+
+    const QString key = entryKey(metaData.url());
+    removeEntry(key);
+
+    QFileInfo info(m_dataDirectory + key);
+    if (info.exists()) {
+        Entry entry;
+        entry.size = info.size();
+        entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+        entry.metaData = metaData;
+        m_index.insert(key, entry);
+        m_totalSize += entry.size;
+    }
+}
+
+// public slots:
+void NetworkDiskCache::clear()
+{
+    QNetworkDiskCache::clear();
+    m_index.clear();
+    m_totalSize = 0;
+}
+
+// private slots:
+void NetworkDiskCache::deviceDestroyed(QObject *device)
+{
+    // Only the QObject part is left: compare the pointers as QObjects
+    QHash<QIODevice *, QNetworkCacheMetaData>::iterator it = m_inserting.begin();
+    while (it != m_inserting.end()) {
+        if (static_cast<QObject *>(it.key()) == device) {
+            it = m_inserting.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// protected:
+qint64 NetworkDiskCache::expire()
+{
+    if (m_totalSize < maximumCacheSize()) {
+        return m_totalSize;
+    }
+
+    const qint64 goal = (maximumCacheSize() * 9) / 10;
+    const QDateTime now = QDateTime::currentDateTime();
+
+    // Entries that are known to be expired go first, then the least recently used
+    QMultiMap<qint64, QString> candidates;
+    QHash<QString, Entry>::const_iterator it = m_index.constBegin();
+    for (; it != m_index.constEnd(); ++it) {
+        const QDateTime expiration = it->metaData.expirationDate();
+        bool expired = expiration.isValid() && expiration < now;
+        candidates.insert(expired ? -1 : it->lastUsed, it.key());
+    }
+
+    QMultiMap<qint64, QString>::const_iterator candidate = candidates.constBegin();
+    for (; candidate != candidates.constEnd() && m_totalSize >= goal; ++candidate) {
+        QFile::remove(m_dataDirectory + candidate.value());
+        removeEntry(candidate.value());
+    }
+
+    return m_totalSize;
+}
+
+// private:
+QString NetworkDiskCache::entryKey(const QUrl &url) const
+{
+    // Same naming scheme as QNetworkDiskCachePrivate::uniqueFileName()
+    QUrl cleanUrl = url;
+    cleanUrl.setPassword(QString());
+    cleanUrl.setFragment(QString());
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(cleanUrl.toEncoded());
+    QByteArray id = QByteArray::number(*(qlonglong *)hash.result().data(), 36).left(8);
+    uint code = (uint)id.at(id.length() - 1) % 16;
+    return QString::number(code, 16) + QLatin1Char('/') + QLatin1String(id) + QLatin1String(CACHE_POSTFIX);
+}
+
+void NetworkDiskCache::loadIndex()
+{
+    // This is the only time the cache directory is walked
+    QDirIterator it(m_dataDirectory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (!path.endsWith(QLatin1String(CACHE_POSTFIX))) {
+            continue;
+        }
+
+        const QFileInfo info = it.fileInfo();
+        Entry entry;
+        entry.size = info.size();
+        entry.lastUsed = info.lastModified().toMSecsSinceEpoch();
+        m_index.insert(path.mid(m_dataDirectory.length()), entry);
+        m_totalSize += entry.size;
+    }
+}
+
+void NetworkDiskCache::removeEntry(const QString &key)
+{
+    QHash<QString, Entry>::iterator it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_totalSize -= it->size;
+        m_index.erase(it);
+    }
+}
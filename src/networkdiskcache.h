@@ -0,0 +1,94 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NETWORKDISKCACHE_H
+#define NETWORKDISKCACHE_H
+
+#include <QHash>
+#include <QNetworkDiskCache>
+#include <QVariantMap>
+
+class Config;
+
+/**
+ * Disk cache shared by the NetworkAccessManager of every page.
+ *
+ * It keeps an in-memory index of the cache directory (file, size, last use
+ * and metadata), built once per process. Lookups of URLs that are not in the
+ * cache never touch the disk, and eviction works off the index instead of
+ * walking the cache directory.
+ */
+class NetworkDiskCache: public QNetworkDiskCache
+{
+    Q_OBJECT
+
+private:
+    NetworkDiskCache(const Config *config, QObject *parent = NULL);
+
+public:
+    static NetworkDiskCache *instance(const Config *config);
+
+    /// "entries", "size" and "maximumSize" (in bytes), and the "hits" and "misses" of lookups
+    QVariantMap statistics() const;
+
+    qint64 cacheSize() const;
+    QNetworkCacheMetaData metaData(const QUrl &url);
+    QIODevice *data(const QUrl &url);
+    bool remove(const QUrl &url);
+    QIODevice *prepare(const QNetworkCacheMetaData &metaData);
+    void insert(QIODevice *device);
+
+public slots:
+    void clear();
+
+private slots:
+    void deviceDestroyed(QObject *device);
+
+protected:
+    qint64 expire();
+
+private:
+    struct Entry {
+        Entry() : size(0), lastUsed(0) {}
+        qint64 size;
+        qint64 lastUsed;
+        QNetworkCacheMetaData metaData;
+    };
+
+    QString entryKey(const QUrl &url) const;
+    void loadIndex();
+    void removeEntry(const QString &key);
+
+    QHash<QString, Entry> m_index;
+    QHash<QIODevice *, QNetworkCacheMetaData> m_inserting;
+    QString m_dataDirectory;
+    qint64 m_totalSize;
+    int m_hits;
+    int m_misses;
+};
+
+#endif // NETWORKDISKCACHE_H
@@ -12,6 +12,9 @@
 
 #include <cassert>
 
+// Default lifetime of the cached proxy results and host lookups
+#define PAC_DEFAULT_CACHE_TTL   (5 * 60 * 1000)
+
 ////////////////////////////////////////////////////////////////////////////////
 //                               NetworkProxyAutoConfigDownloader
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,7 +53,13 @@ QString NetworkProxyAutoConfigDownloader::get(QUrl const & url, unsigned int tim
 NetworkProxyAutoConfig::NetworkProxyAutoConfig(QString const & script)
   : pacScript_(script)
   , page_(new QWebPage())
+  , cacheTtl_(PAC_DEFAULT_CACHE_TTL)
+  , dnsHits_(0)
+  , dnsMisses_(0)
+  , dnsTime_(0)
 {
+    clock_.start();
+
     connect( page_->mainFrame(),
              SIGNAL(javaScriptWindowObjectCleared()),
              this,
@@ -88,13 +97,82 @@ QString NetworkProxyAutoConfig::eval(QString const & url, QString const & host)
     return page_->mainFrame()->evaluateJavaScript(cmd).toString();
 }
 
+void NetworkProxyAutoConfig::setCacheTtl(qint64 msecs)
+{
+    cacheTtl_ = msecs;
+    hosts_.clear();
+}
+
+QVariantMap NetworkProxyAutoConfig::statistics() const
+{
+    QVariantMap stats;
+    stats["dnsHits"] = dnsHits_;
+    stats["dnsMisses"] = dnsMisses_;
+    stats["dnsTime"] = dnsTime_;
+    return stats;
+}
+
+QList<QHostAddress> NetworkProxyAutoConfig::lookup(QString const & host)
+{
+    // IP literals don't need a lookup at all
+    QHostAddress literal;
+    if( literal.setAddress(host) )
+    {
+        return QList<QHostAddress>() << literal;
+    }
+
+    QHash<QString, HostEntry>::iterator entry = hosts_.find(host);
+    if( entry != hosts_.end() )
+    {
+        ++dnsHits_;
+        if( entry->expiry <= clock_.elapsed() && entry->refreshId == -1 )
+        {
+            // Stale: answer with what we have and refresh it in the background
+            entry->refreshId = QHostInfo::lookupHost(host, this, SLOT(onHostLookedUp(QHostInfo)));
+            refreshing_.insert(entry->refreshId, host);
+        }
+        return entry->addresses;
+    }
+
+    // First time we see this host: the script needs the answer now
+    ++dnsMisses_;
+    QElapsedTimer timer;
+    timer.start();
+    QHostInfo const info = QHostInfo::fromName(host);
+    dnsTime_ += timer.elapsed();
+
+    if( cacheTtl_ > 0 )
+    {
+        HostEntry newEntry;
+        newEntry.addresses = info.addresses();
+        newEntry.expiry = clock_.elapsed() + cacheTtl_;
+        newEntry.refreshId = -1;
+        hosts_.insert(host, newEntry);
+    }
+    return info.addresses();
+}
+
+void NetworkProxyAutoConfig::onHostLookedUp(QHostInfo const & info)
+{
+    QString const host = refreshing_.take(info.lookupId());
+    QHash<QString, HostEntry>::iterator entry = hosts_.find(host);
+    if( host.isEmpty() || entry == hosts_.end() || entry->refreshId != info.lookupId() )
+    {
+        return;
+    }
+
+    entry->addresses = info.addresses();
+    entry->expiry = clock_.elapsed() + cacheTtl_;
+    entry->refreshId = -1;
+}
+
 bool NetworkProxyAutoConfig::isInNet(QVariantList args)
 {
     QString host = args[0].toString();
-    QHostInfo info = QHostInfo::fromName(host);
-    if( info.error() == QHostInfo::NoError )
+    QList<QHostAddress> const addresses = lookup(host);
+    if( !addresses.isEmpty() )
     {
-        QHostAddress const hostAddress = info.addresses().first();
+        QHostAddress const hostAddress = addresses.first();
         QString const pattern = args[1].toString();
         QString const mask = args[2].toString();
         QPair<QHostAddress, int> const subnet = QHostAddress::parseSubnet(QString("%1/%2").arg(pattern,mask));
@@ -113,8 +191,7 @@ bool NetworkProxyAutoConfig::isPlainHostName(const QString &host)
 
 QString NetworkProxyAutoConfig::dnsResolve(const QString &host)
 {
-    QHostInfo info = QHostInfo::fromName( host );
-    QList<QHostAddress> addresses = info.addresses();
+    QList<QHostAddress> const addresses = lookup( host );
 
     if( addresses.isEmpty() )
     {
@@ -173,7 +250,12 @@ bool NetworkProxyAutoConfig::isResolvable(const QString &host)
 
 NetworkProxyAutoConfigFactory::NetworkProxyAutoConfigFactory()
   : pac_( 0 )
+  , cacheTtl_( PAC_DEFAULT_CACHE_TTL )
+  , hits_( 0 )
+  , misses_( 0 )
+  , evalTime_( 0 )
 {
+    clock_.start();
 }
 
 NetworkProxyAutoConfigFactory::~NetworkProxyAutoConfigFactory()
@@ -191,8 +273,10 @@ void NetworkProxyAutoConfigFactory::setProxyAutoConfig(QString const & url)
     if( !script.isEmpty() )
     {
         NetworkProxyAutoConfig* tmp( new NetworkProxyAutoConfig( script ));
+        tmp->setCacheTtl( cacheTtl_ );
         std::swap(pac_, tmp);
         delete tmp;
+        proxies_.clear();
     }
 }
 
@@ -219,7 +303,65 @@ static void addProxy(
     proxyList.append( QNetworkProxy( type, host, port, user, password ));
 }
 
+void NetworkProxyAutoConfigFactory::setCacheTtl(qint64 msecs)
+{
+    cacheTtl_ = msecs;
+    proxies_.clear();
+    if( pac_ )
+    {
+        pac_->setCacheTtl( msecs );
+    }
+}
+
+QVariantMap NetworkProxyAutoConfigFactory::statistics() const
+{
+    QVariantMap stats;
+    if( pac_ )
+    {
+        stats = pac_->statistics();
+    }
+    stats["hits"] = hits_;
+    stats["misses"] = misses_;
+    stats["evalTime"] = evalTime_;
+    return stats;
+}
+
 QList<QNetworkProxy> NetworkProxyAutoConfigFactory::queryProxy(const QNetworkProxyQuery& query)
+{
+    if( !pac_ )
+    {
+        return evalProxies( query );
+    }
+
+    // Scripts are expected to decide on scheme and host: reuse the result for every
+    // resource of the same origin instead of running the script once per request
+    QString const key = query.url().scheme() + "://" + query.peerHostName();
+    if( cacheTtl_ > 0 )
+    {
+        QHash<QString, ProxiesEntry>::const_iterator cached = proxies_.constFind( key );
+        if( cached != proxies_.constEnd() && cached->expiry > clock_.elapsed() )
+        {
+            ++hits_;
+            return cached->proxies;
+        }
+    }
+
+    ++misses_;
+    QElapsedTimer timer;
+    timer.start();
+    ProxiesEntry entry;
+    entry.proxies = evalProxies( query );
+    entry.expiry = clock_.elapsed() + cacheTtl_;
+    evalTime_ += timer.elapsed();
+
+    if( cacheTtl_ > 0 )
+    {
+        proxies_.insert( key, entry );
+    }
+    return entry.proxies;
+}
+
+QList<QNetworkProxy> NetworkProxyAutoConfigFactory::evalProxies(const QNetworkProxyQuery& query)
 {
     QList<QNetworkProxy> proxyList;
     if( pac_ )
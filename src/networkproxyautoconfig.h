@@ -6,6 +6,10 @@
 #include <QtCore/QUrl>
 #include <QWebPage>
 #include <QVariant>
+#include <QHash>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QElapsedTimer>
 
 class NetworkProxyAutoConfigDownloader : public QObject
 {
@@ -40,6 +44,16 @@ public:
      *  @brief: runs the proxy auto config file
      */
     QString eval(QString const & url, QString const & host);
+
+    /**
+     *  @brief: how long (in milliseconds) host lookups are reused; 0 disables the cache
+     */
+    void setCacheTtl(qint64 msecs);
+
+    /**
+     *  @brief: host lookup counters: "dnsHits", "dnsMisses" and "dnsTime" (milliseconds)
+     */
+    QVariantMap statistics() const;
 public slots:
     bool isInNet(QVariantList args);
     bool isPlainHostName(const QString &host);
@@ -52,10 +66,27 @@ public slots:
 
 private slots:
     void onCreateObjects();
+    void onHostLookedUp(QHostInfo const & info);
 
 private:
+    struct HostEntry
+    {
+        QList<QHostAddress> addresses;
+        qint64 expiry;
+        int refreshId;
+    };
+
+    QList<QHostAddress> lookup(QString const & host);
+
     QString pacScript_;
     QWebPage* page_;
+    QHash<QString, HostEntry> hosts_;
+    QHash<int, QString> refreshing_;
+    QElapsedTimer clock_;
+    qint64 cacheTtl_;
+    qint64 dnsHits_;
+    qint64 dnsMisses_;
+    qint64 dnsTime_;
 };
       
 class NetworkProxyAutoConfigFactory : public QNetworkProxyFactory
@@ -67,6 +98,18 @@ public:
     void setProxyAutoConfig(QString const & url);
     virtual QList<QNetworkProxy> queryProxy(const QNetworkProxyQuery & query);
 
+    /**
+     *  @brief: how long (in milliseconds) the proxies found for a scheme and host,
+     *  and the host lookups done by the script, are reused; 0 disables the cache
+     */
+    void setCacheTtl(qint64 msecs);
+
+    /**
+     *  @brief: "hits", "misses" and "evalTime" (milliseconds) of the proxy queries,
+     *  plus the host lookup counters of the script
+     */
+    QVariantMap statistics() const;
+
     void setUser(QString const & s)
     {
         user_ = s;
@@ -88,9 +131,23 @@ public:
     }
 
 private:
+    struct ProxiesEntry
+    {
+        QList<QNetworkProxy> proxies;
+        qint64 expiry;
+    };
+
+    QList<QNetworkProxy> evalProxies(const QNetworkProxyQuery & query);
+
     NetworkProxyAutoConfig* pac_;
     QString user_;
     QString password_;
+    QHash<QString, ProxiesEntry> proxies_;
+    QElapsedTimer clock_;
+    qint64 cacheTtl_;
+    qint64 hits_;
+    qint64 misses_;
+    qint64 evalTime_;
 };
 
 #endif // NETWORK_PROXY_AUTO_CONFIG_H_7E83DFB1_54E9_4DAA_BAF5_8B9D79933814
@@ -35,19 +35,40 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QWebPage>
+#include <QWebSettings>
 
 #include "consts.h"
 #include "terminal.h"
 #include "utils.h"
 #include "webpage.h"
 #include "webserver.h"
+#include "childprocess.h"
 #include "repl.h"
 #include "system.h"
 #include "callback.h"
+#include "compilecache.h"
 #include "cookiejar.h"
+#include "networkdiskcache.h"
+#include "hostinfocache.h"
+#include "csconverter.h"
 
 #include "networkproxyautoconfig.h"
 
+#define DEFAULT_PAGE_POOL_SIZE 4
+
+// Exported by QtWebKit (see "DumpRenderTreeSupportQt.cpp")
+QWEBKIT_EXPORT void qt_drt_garbageCollector_collect();
+QWEBKIT_EXPORT QVariantMap qt_drt_javaScriptHeapStatistics();
+QWEBKIT_EXPORT QVariantMap qt_drt_memoryCacheStatistics();
+
+// Exported by QtNetwork (see "qnetworkaccessmanager.cpp", "qnetworkaccesscache.cpp"
+// and "qsslsocket_openssl.cpp")
+QT_BEGIN_NAMESPACE
+Q_NETWORK_EXPORT void qt_qnetworkaccessmanager_share_http_thread(bool share);
+Q_NETWORK_EXPORT void qt_qnetworkaccesscache_set_expiry_time(int seconds);
+Q_NETWORK_EXPORT void qt_qsslsocket_enable_session_cache(bool enable);
+QT_END_NAMESPACE
+
 static Phantom *phantomInstance = NULL;
 
 // private:
@@ -57,6 +78,8 @@ Phantom::Phantom(QObject *parent)
     , m_returnValue(0)
     , m_filesystem(0)
     , m_system(0)
+    , m_proxyAutoConfigFactory(0)
+    , m_pagePoolSize(DEFAULT_PAGE_POOL_SIZE)
 {
     QStringList args = QApplication::arguments();
 
@@ -65,6 +88,7 @@ Phantom::Phantom(QObject *parent)
     m_config.init(&args);
     // Apply debug configuration as early as possible
     Utils::printDebugMessages = m_config.printDebugMessages();
+    Utils::markStartupPhase("config");
 }
 
 void Phantom::init()
@@ -94,12 +118,33 @@ void Phantom::init()
     // Initialize the CookieJar
     CookieJar::instance(m_config.cookiesFile());
 
+    // Must be set before the first page (and its NetworkAccessManager) is created:
+    // with a single HTTP thread, all the pages draw from the same connection pool, and
+    // a connection authenticated (e.g. NTLM) for one page can be reused by another
+    qt_qnetworkaccessmanager_share_http_thread(m_config.sharedConnectionsEnabled());
+    qt_qnetworkaccesscache_set_expiry_time(m_config.connectionIdleTimeout());
+    qt_qsslsocket_enable_session_cache(m_config.sslSessionResumptionEnabled());
+    HostInfoCache::instance();
+
+    // WebCore memory cache (in KB, as the disk cache) and page cache: WebKit defaults unless set
+    if (m_config.memoryCacheSize() >= 0 || m_config.memoryCacheMinDeadSize() >= 0 || m_config.memoryCacheMaxDeadSize() >= 0) {
+        const int total = m_config.memoryCacheSize() >= 0 ? m_config.memoryCacheSize() : 8192;
+        const int maxDead = m_config.memoryCacheMaxDeadSize() >= 0 ? m_config.memoryCacheMaxDeadSize() : total;
+        const int minDead = m_config.memoryCacheMinDeadSize() >= 0 ? m_config.memoryCacheMinDeadSize() : 0;
+        QWebSettings::setObjectCacheCapacities(minDead * 1024, maxDead * 1024, total * 1024);
+    }
+    if (m_config.maxPagesInCache() >= 0) {
+        QWebSettings::setMaximumPagesInCache(m_config.maxPagesInCache());
+    }
+
     m_page = new WebPage(this, QUrl::fromLocalFile(m_config.scriptFile()));
     m_pages.append(m_page);
+    Utils::markStartupPhase("page");
 
     if (!m_config.proxyAutoConfig().isEmpty())
     {
         NetworkProxyAutoConfigFactory* pf(new NetworkProxyAutoConfigFactory());
+        pf->setCacheTtl(qMax(m_config.proxyAutoConfigCacheTtl(), 0) * 1000);
         pf->setProxyAutoConfig(m_config.proxyAutoConfig());
         if(!m_config.proxyAuthUser().isEmpty() && !m_config.proxyAuthPass().isEmpty()) 
         {
@@ -107,6 +152,7 @@ void Phantom::init()
             pf->setPassword(m_config.proxyAuthPass());
         }
         QNetworkProxyFactory::setApplicationProxyFactory(pf);
+        m_proxyAutoConfigFactory = pf;
     }
     else {
         QString proxyType = m_config.proxyType();
@@ -150,9 +196,16 @@ void Phantom::init()
     m_defaultPageSettings[PAGE_SETTINGS_WEB_SECURITY_ENABLED] = QVariant::fromValue(m_config.webSecurityEnabled());
     m_defaultPageSettings[PAGE_SETTINGS_JS_CAN_OPEN_WINDOWS] = QVariant::fromValue(m_config.javascriptCanOpenWindows());
     m_defaultPageSettings[PAGE_SETTINGS_JS_CAN_CLOSE_WINDOWS] = QVariant::fromValue(m_config.javascriptCanCloseWindows());
+    m_defaultPageSettings[PAGE_SETTINGS_MAX_CONNECTIONS] = QVariant::fromValue(m_config.maxConnectionsPerHost());
+    m_defaultPageSettings[PAGE_SETTINGS_HOST_CONNECTIONS] = QVariant::fromValue(m_config.hostConnections());
+    m_defaultPageSettings[PAGE_SETTINGS_HTTP_PIPELINING] = QVariant::fromValue(m_config.httpPipeliningEnabled());
+    m_defaultPageSettings[PAGE_SETTINGS_HTTP_PIPELINE_LENGTH] = QVariant::fromValue(m_config.httpPipelineLength());
+    m_defaultPageSettings[PAGE_SETTINGS_RESOURCE_TIMEOUT] = QVariant::fromValue(0);
+    m_defaultPageSettings[PAGE_SETTINGS_HOST_RESOURCE_TIMEOUTS] = QVariant::fromValue(QVariantMap());
     m_page->applySettings(m_defaultPageSettings);
 
     setLibraryPath(QFileInfo(m_config.scriptFile()).dir().absolutePath());
+    Utils::markStartupPhase("init");
 }
 
 // public:
@@ -276,6 +329,24 @@ void Phantom::setCookiesEnabled(const bool value)
     }
 }
 
+bool Phantom::isDiskCacheEnabled() const
+{
+    return m_config.diskCacheEnabled();
+}
+
+void Phantom::setDiskCacheEnabled(const bool value)
+{
+    m_config.setDiskCacheEnabled(value);
+}
+
+QVariantMap Phantom::diskCacheStatistics() const
+{
+    if (m_config.diskCacheEnabled()) {
+        return NetworkDiskCache::instance(&m_config)->statistics();
+    }
+    return QVariantMap();
+}
+
 // public slots:
 QObject *Phantom::createWebPage()
 {
@@ -294,6 +365,52 @@ QObject *Phantom::createWebPage()
     return page;
 }
 
+QObject *Phantom::acquireWebPage()
+{
+    while (!m_pagePool.isEmpty()) {
+        QPointer<WebPage> page = m_pagePool.takeLast();
+        if (page) {
+            return page;
+        }
+    }
+    return createWebPage();
+}
+
+bool Phantom::recycleWebPage(QObject *page)
+{
+    WebPage *webPage = qobject_cast<WebPage *>(page);
+    // Only pages created by us, child pages go away with their parent
+    if (!webPage || webPage == m_page || webPage->parent() != this || m_pagePool.contains(webPage)) {
+        return false;
+    }
+
+    if (m_pagePool.count() >= m_pagePoolSize) {
+        webPage->close();
+        return false;
+    }
+
+    webPage->reset();
+    webPage->applySettings(m_defaultPageSettings);
+    m_pagePool.append(webPage);
+    return true;
+}
+
+int Phantom::pagePoolSize() const
+{
+    return m_pagePoolSize;
+}
+
+void Phantom::setPagePoolSize(const int size)
+{
+    m_pagePoolSize = qMax(size, 0);
+    while (m_pagePool.count() > m_pagePoolSize) {
+        QPointer<WebPage> page = m_pagePool.takeFirst();
+        if (page) {
+            page->close();
+        }
+    }
+}
+
 QObject* Phantom::createWebServer()
 {
     WebServer *server = new WebServer(this);
@@ -301,6 +418,11 @@ QObject* Phantom::createWebServer()
     return server;
 }
 
+QObject *Phantom::createChildProcess()
+{
+    return new ChildProcess(this);
+}
+
 QObject *Phantom::createFilesystem()
 {
     if (!m_filesystem)
@@ -344,6 +466,16 @@ void Phantom::loadModule(const QString &moduleSource, const QString &filename)
    m_page->mainFrame()->evaluateJavaScript(scriptSource, filename);
 }
 
+QString Phantom::_findCompiledCoffeeScript(const QString &source)
+{
+    return CompileCache::instance()->find(CSConverter::compilerId(), source);
+}
+
+void Phantom::_storeCompiledCoffeeScript(const QString &source, const QString &compiled)
+{
+    CompileCache::instance()->insert(CSConverter::compilerId(), source, compiled);
+}
+
 bool Phantom::injectJs(const QString &jsFilePath)
 {
     if (m_terminated)
@@ -366,6 +498,63 @@ void Phantom::debugExit(int code)
     doExit(code);
 }
 
+QVariantMap Phantom::memoryCacheStatistics() const
+{
+    QVariantMap statistics = qt_drt_memoryCacheStatistics();
+
+    // WebCore counts the capacities in bytes, the options in KB
+    QVariantMap capacities = statistics.value("capacities").toMap();
+    foreach (const QString &key, capacities.keys()) {
+        capacities[key] = capacities.value(key).toInt() / 1024;
+    }
+    statistics["capacities"] = capacities;
+    return statistics;
+}
+
+void Phantom::setMemoryCacheCapacities(const QVariantMap &capacities)
+{
+    const QVariantMap current = memoryCacheStatistics().value("capacities").toMap();
+    const int size = capacities.value("size", current.value("size")).toInt();
+    // WebCore expects minDeadSize <= maxDeadSize <= size
+    const int maxDead = qMin(capacities.value("maxDeadSize", current.value("maxDeadSize")).toInt(), size);
+    const int minDead = qMin(capacities.value("minDeadSize", current.value("minDeadSize")).toInt(), maxDead);
+    QWebSettings::setObjectCacheCapacities(minDead * 1024, maxDead * 1024, size * 1024);
+
+    if (capacities.contains("pageCache")) {
+        QWebSettings::setMaximumPagesInCache(capacities.value("pageCache").toInt());
+    }
+}
+
+void Phantom::pruneMemoryCache()
+{
+    QWebSettings::clearMemoryCaches();
+}
+
+int Phantom::prefetchHosts(const QStringList &hosts)
+{
+    return HostInfoCache::instance()->prefetch(hosts);
+}
+
+QVariantMap Phantom::startupTimings() const
+{
+    return Utils::startupTimings();
+}
+
+QVariantMap Phantom::scriptCacheStatistics() const
+{
+    return Utils::scriptCacheStatistics();
+}
+
+QVariantMap Phantom::heapStatistics() const
+{
+    return qt_drt_javaScriptHeapStatistics();
+}
+
+void Phantom::gc()
+{
+    qt_drt_garbageCollector_collect();
+}
+
 // private slots:
 void Phantom::printConsoleMessage(const QString &message)
 {
@@ -382,6 +571,8 @@ void Phantom::onInitialized()
                 Utils::readResourceFileUtf8(":/bootstrap.js"),
                 QString("phantomjs://bootstrap.js")
                 );
+    // The user script starts right after
+    Utils::markStartupPhase("bootstrap");
 }
 
 bool Phantom::setCookies(const QVariantList &cookies)
@@ -392,6 +583,14 @@ bool Phantom::setCookies(const QVariantList &cookies)
     return CookieJar::instance()->addCookiesFromMap(cookies);
 }
 
+QVariantMap Phantom::proxyAutoConfigStatistics() const
+{
+    if (m_proxyAutoConfigFactory) {
+        return m_proxyAutoConfigFactory->statistics();
+    }
+    return QVariantMap();
+}
+
 QVariantList Phantom::cookies() const
 {
     // Return all the Cookies in the CookieJar, as a list of Maps (aka JSON in JS space)
@@ -426,6 +625,7 @@ void Phantom::doExit(int code)
     }
 
     emit aboutToExit(code);
+    HostInfoCache::instance()->save();
     m_terminated = true;
     m_returnValue = code;
     qDeleteAll(m_pages);
@@ -445,12 +645,24 @@ void Phantom::initCompletions()
     addCompletion("scriptName");
     addCompletion("version");
     addCompletion("cookiesEnabled");
+    addCompletion("diskCacheEnabled");
+    addCompletion("diskCacheStatistics");
     addCompletion("cookies");
+    addCompletion("proxyAutoConfigStatistics");
+    addCompletion("pagePoolSize");
+    addCompletion("startupTimings");
+    addCompletion("scriptCacheStatistics");
     // functions
     addCompletion("exit");
+    addCompletion("prefetchHosts");
+    addCompletion("memoryCacheStatistics");
+    addCompletion("setMemoryCacheCapacities");
+    addCompletion("pruneMemoryCache");
     addCompletion("debugExit");
     addCompletion("injectJs");
     addCompletion("addCookie");
     addCompletion("deleteCookie");
     addCompletion("clearCookies");
+    addCompletion("heapStatistics");
+    addCompletion("gc");
 }
@@ -43,6 +43,7 @@
 class WebPage;
 class CustomPage;
 class WebServer;
+class NetworkProxyAutoConfigFactory;
 
 class Phantom: public REPLCompletable
 {
@@ -55,7 +56,13 @@ class Phantom: public REPLCompletable
     Q_PROPERTY(QVariantMap version READ version)
     Q_PROPERTY(QObject *page READ page)
     Q_PROPERTY(bool cookiesEnabled READ areCookiesEnabled WRITE setCookiesEnabled)
+    Q_PROPERTY(bool diskCacheEnabled READ isDiskCacheEnabled WRITE setDiskCacheEnabled)
+    Q_PROPERTY(QVariantMap diskCacheStatistics READ diskCacheStatistics)
     Q_PROPERTY(QVariantList cookies READ cookies WRITE setCookies)
+    Q_PROPERTY(QVariantMap proxyAutoConfigStatistics READ proxyAutoConfigStatistics)
+    Q_PROPERTY(int pagePoolSize READ pagePoolSize WRITE setPagePoolSize)
+    Q_PROPERTY(QVariantMap startupTimings READ startupTimings)
+    Q_PROPERTY(QVariantMap scriptCacheStatistics READ scriptCacheStatistics)
 
 private:
     // Private constructor: the Phantom class is a singleton
@@ -99,13 +106,90 @@ public:
     bool areCookiesEnabled() const;
     void setCookiesEnabled(const bool value);
 
+    /**
+     * Whether the pages use the disk cache (see option '--disk-cache').
+     * A change applies to the pages created afterwards.
+     *
+     * @brief diskCacheEnabled
+     */
+    bool isDiskCacheEnabled() const;
+    void setDiskCacheEnabled(const bool value);
+
+    /**
+     * Content of the disk cache shared by the pages: number of "entries",
+     * their "size" and the "maximumSize" (in bytes), and the "hits" and
+     * "misses" of the lookups.
+     *
+     * @brief diskCacheStatistics
+     * @return Empty map if the disk cache is not enabled
+     */
+    QVariantMap diskCacheStatistics() const;
+
+    /**
+     * Counters of the proxy auto-config (see option '--pac'):
+     * "hits"/"misses" of the cached proxy results, "dnsHits"/"dnsMisses" of the
+     * host lookups done by the script, and "evalTime"/"dnsTime" spent on them (in ms).
+     *
+     * @brief proxyAutoConfigStatistics
+     * @return Empty map if no proxy auto-config is in use
+     */
+    QVariantMap proxyAutoConfigStatistics() const;
+
+    /**
+     * How many recycled pages are kept around for @c acquireWebPage().
+     *
+     * @brief pagePoolSize
+     * @return Maximum number of pooled pages
+     */
+    int pagePoolSize() const;
+    void setPagePoolSize(const int size);
+
+    /**
+     * Time (in ms) spent in each startup phase, from main() to the first statement
+     * of the script: "breakpad", "qca", "application", "config", "page" (first WebPage),
+     * "init" (rest of Phantom::init), "bootstrap", and the "total".
+     *
+     * @brief startupTimings
+     * @return Map of phase durations
+     */
+    QVariantMap startupTimings() const;
+
+    /**
+     * Scripts read by injectJs() are kept decoded (and compiled) in memory
+     * for as long as their content does not change.
+     *
+     * @brief scriptCacheStatistics
+     * @return Map of the "entries" in the cache, and its "hits" and "misses" so far
+     */
+    QVariantMap scriptCacheStatistics() const;
+
 public slots:
     QObject *createWebPage();
+    /**
+     * Like @c createWebPage(), but hands out a previously recycled page if there is one.
+     *
+     * @brief acquireWebPage
+     * @return A pooled or a new page
+     */
+    QObject *acquireWebPage();
+    /**
+     * Resets @p page (see WebPage::reset()) and puts it back into the pool
+     * for @c acquireWebPage(). If the pool is full, the page is closed instead.
+     *
+     * @brief recycleWebPage
+     * @param page A page obtained from @c createWebPage() or @c acquireWebPage()
+     * @return true if the page has been pooled
+     */
+    bool recycleWebPage(QObject *page);
     QObject *createWebServer();
+    QObject *createChildProcess();
     QObject *createFilesystem();
     QObject *createSystem();
     QObject *createCallback();
     void loadModule(const QString &moduleSource, const QString &filename);
+    // Access to the compile cache for the CoffeeScript "require()" extension
+    QString _findCompiledCoffeeScript(const QString &source);
+    void _storeCompiledCoffeeScript(const QString &source, const QString &compiled);
     bool injectJs(const QString &jsFilePath);
 
     /**
@@ -162,6 +246,61 @@ public slots:
     void exit(int code = 0);
     void debugExit(int code = 0);
 
+    /**
+     * Counters of the JavaScript heap shared by all pages: "size" and "capacity"
+     * (in bytes), "objectCount", "globalObjectCount", "protectedObjectCount",
+     * and "collectionCount"/"collectionTime" (in ms) of the garbage collections so far.
+     *
+     * @brief heapStatistics
+     * @return Map of heap counters
+     */
+    QVariantMap heapStatistics() const;
+    /**
+     * Run a full garbage collection now, e.g. before starting a measurement.
+     * Otherwise the heap is collected when idle, a while after the last collection.
+     *
+     * @brief gc
+     */
+    void gc();
+    /**
+     * Start looking up @p hosts in parallel, so that the first requests to
+     * them find the addresses in the cache.
+     *
+     * @brief prefetchHosts
+     * @param hosts Host names
+     * @return Number of lookups started
+     */
+    int prefetchHosts(const QStringList &hosts);
+    /**
+     * Content of the WebCore memory cache, shared by all the pages: "images",
+     * "cssStyleSheets", "scripts" and "fonts", each with "count", "size",
+     * "liveSize" (used by a page) and "decodedSize" (in bytes), the
+     * "count" and "capacity" of the "pageCache" (back/forward), and the
+     * "capacities" of the memory cache: "size", "minDeadSize" and
+     * "maxDeadSize" (in KB, like the "--memory-cache-*" options).
+     *
+     * @brief memoryCacheStatistics
+     * @return Map of cache counters
+     */
+    QVariantMap memoryCacheStatistics() const;
+    /**
+     * Change the memory cache capacities at runtime, with the keys of the
+     * "capacities" of @c memoryCacheStatistics() (in KB), and "pageCache"
+     * for the number of pages kept for going back and forward.
+     * Missing keys keep their current value.
+     *
+     * @brief setMemoryCacheCapacities
+     * @param capacities Map of the capacities to change
+     */
+    void setMemoryCacheCapacities(const QVariantMap &capacities);
+    /**
+     * Drop what no page uses from the memory cache and the page cache, and
+     * release the inactive fonts.
+     *
+     * @brief pruneMemoryCache
+     */
+    void pruneMemoryCache();
+
 signals:
     void aboutToExit(int code);
 
@@ -183,7 +322,10 @@ private:
     FileSystem *m_filesystem;
     System *m_system;
     QList<QPointer<WebPage> > m_pages;
+    QList<QPointer<WebPage> > m_pagePool;
+    int m_pagePoolSize;
     QList<QPointer<WebServer> > m_servers;
+    NetworkProxyAutoConfigFactory *m_proxyAutoConfigFactory;
     Config m_config;
 
     friend class CustomPage;
@@ -10,13 +10,18 @@ RESOURCES = phantomjs.qrc \
     qt/src/3rdparty/webkit/Source/WebCore/generated/InspectorBackendStub.qrc
 
 HEADERS += csconverter.h \
+    compilecache.h \
+    hostinfocache.h \
     phantom.h \
     callback.h \
     webpage.h \
     webserver.h \
+    childprocess.h \
     consts.h \
     utils.h \
     networkaccessmanager.h \
+    urlblocklist.h \
+    networkdiskcache.h \
     cookiejar.h \
     filesystem.h \
     system.h \
@@ -32,10 +37,15 @@ SOURCES += phantom.cpp \
     callback.cpp \
     webpage.cpp \
     webserver.cpp \
+    childprocess.cpp \
     main.cpp \
     csconverter.cpp \
+    compilecache.cpp \
+    hostinfocache.cpp \
     utils.cpp \
     networkaccessmanager.cpp \
+    urlblocklist.cpp \
+    networkdiskcache.cpp \
     cookiejar.cpp \
     filesystem.cpp \
     system.cpp \
@@ -49,13 +59,14 @@ SOURCES += phantom.cpp \
 
 OTHER_FILES += \
     bootstrap.js \
-    configurator.js \
     modules/fs.js \
     modules/webpage.js \
     modules/webserver.js \
+    modules/child_process.js \
     repl.js
 
 include(gif/gif.pri)
+include(encoder/encoder.pri)
 include(mongoose/mongoose.pri)
 include(linenoise/linenoise.pri)
 include(qca/qca-2.0.3/app.pri)
@@ -142,7 +142,7 @@ SOURCES += \
     runtime/Executable.cpp \
     runtime/FunctionConstructor.cpp \
     runtime/FunctionPrototype.cpp \
-    runtime/GCActivityCallback.cpp \
+    runtime/GCActivityCallbackQt.cpp \
     runtime/GetterSetter.cpp \
     runtime/Identifier.cpp \
     runtime/InitializeThreading.cpp \
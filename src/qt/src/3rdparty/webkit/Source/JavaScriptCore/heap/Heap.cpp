@@ -31,6 +31,7 @@
 #include "JSONObject.h"
 #include "Tracing.h"
 #include <algorithm>
+#include <wtf/CurrentTime.h>
 
 #define COLLECT_ON_EVERY_SLOW_ALLOCATION 0
 
@@ -50,6 +51,8 @@ Heap::Heap(JSGlobalData* globalData)
     , m_markStack(globalData->jsArrayVPtr)
     , m_handleHeap(globalData)
     , m_extraCost(0)
+    , m_collectionCount(0)
+    , m_collectionTime(0)
 {
     m_markedSpace.setHighWaterMark(minBytesPerCycle);
     (*m_activityCallback)();
@@ -393,6 +396,7 @@ void Heap::reset(SweepToggle sweepToggle)
 {
     ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
     JAVASCRIPTCORE_GC_BEGIN();
+    double startTime = currentTime();
 
     markRoots();
     m_handleHeap.finalizeWeakHandles();
@@ -418,6 +422,9 @@ void Heap::reset(SweepToggle sweepToggle)
     size_t proportionalBytes = 2 * m_markedSpace.size();
     m_markedSpace.setHighWaterMark(max(proportionalBytes, minBytesPerCycle));
 
+    m_collectionTime += currentTime() - startTime;
+    ++m_collectionCount;
+
     JAVASCRIPTCORE_GC_END();
 
     (*m_activityCallback)();
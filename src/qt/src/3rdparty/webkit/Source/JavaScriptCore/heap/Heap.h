@@ -90,6 +90,8 @@ namespace JSC {
         size_t globalObjectCount();
         size_t protectedObjectCount();
         size_t protectedGlobalObjectCount();
+        size_t collectionCount() const { return m_collectionCount; }
+        double collectionTime() const { return m_collectionTime; } // seconds spent in collections
         PassOwnPtr<TypeCountSet> protectedObjectTypeCounts();
         PassOwnPtr<TypeCountSet> objectTypeCounts();
 
@@ -141,6 +143,9 @@ namespace JSC {
         HandleStack m_handleStack;
 
         size_t m_extraCost;
+
+        size_t m_collectionCount;
+        double m_collectionTime;
     };
 
     inline bool Heap::isMarked(const JSCell* cell)
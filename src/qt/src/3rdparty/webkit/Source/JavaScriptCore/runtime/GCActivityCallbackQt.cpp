@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2010 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer. 
+ * 2.  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution. 
+ * 3.  Neither the name of Apple Computer, Inc. ("Apple") nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission. 
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE AND ITS CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL APPLE OR ITS CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "GCActivityCallback.h"
+
+#include "APIShims.h"
+#include "Heap.h"
+#include "JSGlobalData.h"
+#include "JSLock.h"
+#include <QtCore/QBasicTimer>
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QTimerEvent>
+
+#if !PLATFORM(QT)
+#error "This file should only be used on Qt platforms."
+#endif
+
+namespace JSC {
+
+// Same policy as the CF implementation: collect a while after the last
+// collection, but only from the event loop, i.e. when no script is running.
+struct DefaultGCActivityCallbackPlatformData : public QObject {
+    DefaultGCActivityCallbackPlatformData(Heap* heap)
+        : heap(heap)
+        , collecting(false)
+    {
+    }
+
+    virtual void timerEvent(QTimerEvent*);
+
+    Heap* heap;
+    QBasicTimer timer;
+    bool collecting;
+};
+
+const int triggerInterval = 2000; // milliseconds
+
+void DefaultGCActivityCallbackPlatformData::timerEvent(QTimerEvent* event)
+{
+    if (event->timerId() != timer.timerId() || !heap)
+        return;
+
+    // A nested event loop may run while a script is on the stack, try again later.
+    if (heap->isBusy() || heap->globalData()->dynamicGlobalObject) {
+        timer.start(triggerInterval, this);
+        return;
+    }
+
+    // The collection calls back into operator(), which must not start the
+    // timer again: an idle heap is collected once, not every interval.
+    timer.stop();
+    collecting = true;
+    {
+        APIEntryShim shim(heap->globalData());
+        heap->collectAllGarbage();
+    }
+    collecting = false;
+    ASSERT(!timer.isActive());
+}
+
+DefaultGCActivityCallback::DefaultGCActivityCallback(Heap* heap)
+{
+    d = adoptPtr(new DefaultGCActivityCallbackPlatformData(heap));
+}
+
+DefaultGCActivityCallback::~DefaultGCActivityCallback()
+{
+    d->timer.stop();
+}
+
+void DefaultGCActivityCallback::operator()()
+{
+    // Timers can only be started from the thread the heap was created on.
+    if (QThread::currentThread() != d->thread() || d->collecting)
+        return;
+    d->timer.start(triggerInterval, d.get());
+}
+
+void DefaultGCActivityCallback::synchronize()
+{
+    if (QThread::currentThread() == d->thread())
+        return;
+    // The heap moved to another thread: QObjects can only be pushed away
+    // from their own thread, so start over with a new timer owned by this one.
+    Heap* heap = d->heap;
+    d->heap = 0;
+    d.leakPtr()->deleteLater();
+    d = adoptPtr(new DefaultGCActivityCallbackPlatformData(heap));
+}
+
+}
@@ -88,6 +88,7 @@ enum SerializationTag {
     EmptyStringTag = 17,
     RegExpTag = 18,
     ObjectReferenceTag = 19,
+    NumberArrayTag = 20,
     ErrorTag = 255
 };
 
@@ -96,11 +97,15 @@ enum SerializationTag {
  *
  * Initial version was 1.
  * Version 2. added the ObjectReferenceTag and support for serialization of cyclic graphs.
+ * Version 3. added the NumberArrayTag for dense arrays of numbers.
  */
-static const unsigned int CurrentVersion = 2;
+static const unsigned int CurrentVersion = 3;
 static const unsigned int TerminatorTag = 0xFFFFFFFF;
 static const unsigned int StringPoolTag = 0xFFFFFFFE;
 
+// Dense arrays of numbers at least this long are written as NumberArray
+static const unsigned int minimumNumberArrayLength = 8;
+
 /*
  * Object serialization is performed according to the following grammar, all tags
  * are recorded as a single uint8_t.
@@ -132,6 +137,7 @@ static const unsigned int StringPoolTag = 0xFFFFFFFE;
  *    | FileList
  *    | ImageData
  *    | Blob
+ *    | NumberArray
  *    | ObjectReferenceTag <opIndex:IndexType>
  *
  * String :-
@@ -159,6 +165,9 @@ static const unsigned int StringPoolTag = 0xFFFFFFFE;
  *
  * RegExp :-
  *    RegExpTag <pattern:StringData><flags:StringData>
+ *
+ * NumberArray :-
+ *    NumberArrayTag <length:uint32_t><values:double{length}> // Added to the object pool like Array
  */
 
 typedef pair<JSC::JSValue, SerializationReturnCode> DeserializationResult;
@@ -287,6 +296,21 @@ private:
         return isJSArray(&m_exec->globalData(), object) || object->inherits(&JSArray::s_info);
     }
 
+    bool isNumberArray(JSValue value)
+    {
+        if (!value.isObject() || !isJSArray(&m_exec->globalData(), asObject(value)))
+            return false;
+        JSArray* array = asArray(value);
+        unsigned length = array->length();
+        if (length < minimumNumberArrayLength || length > numeric_limits<uint32_t>::max() / sizeof(double))
+            return false;
+        for (unsigned i = 0; i < length; i++) {
+            if (!array->canGetIndex(i) || !array->getIndex(i).isNumber())
+                return false;
+        }
+        return true;
+    }
+
     bool startObjectInternal(JSObject* object)
     {
         // Record object for graph reconstruction
@@ -415,6 +439,19 @@ private:
             return true;
         }
 
+        if (isNumberArray(value)) {
+            JSArray* array = asArray(value);
+            if (!startObjectInternal(array))
+                return true;
+            unsigned length = array->length();
+            write(NumberArrayTag);
+            write(length);
+            m_buffer.reserveCapacity(m_buffer.size() + length * sizeof(double));
+            for (unsigned i = 0; i < length; i++)
+                write(array->getIndex(i).uncheckedGetNumber());
+            return true;
+        }
+
         if (isArray(value))
             return false;
            
@@ -1169,6 +1206,24 @@ private:
             RefPtr<RegExp> regExp = RegExp::create(&m_exec->globalData(), pattern->ustring(), reFlags);
             return new (m_exec) RegExpObject(m_exec->lexicalGlobalObject(), m_globalObject->regExpStructure(), regExp); 
         }
+        case NumberArrayTag: {
+            uint32_t length;
+            if (!read(length))
+                return JSValue();
+            if (length > numeric_limits<uint32_t>::max() / sizeof(double) || m_ptr > m_end - length * sizeof(double)) {
+                fail();
+                return JSValue();
+            }
+            JSArray* outArray = new (m_exec) JSArray(m_exec->globalData(), m_globalObject->arrayStructure(), length, CreateCompact);
+            for (unsigned i = 0; i < length; i++) {
+                double d;
+                read(d);
+                outArray->uncheckedSetIndex(m_exec->globalData(), i, jsNumber(d));
+            }
+            outArray->setLength(length);
+            m_gcBuffer.append(outArray);
+            return outArray;
+        }
         case ObjectReferenceTag: {
             unsigned index = 0;
             if (!readConstantPoolIndex(m_gcBuffer, index)) {
@@ -41,8 +41,10 @@
 #include "PropertyNameArray.h"
 #include "RegExpConstructor.h"
 #include "RegExpObject.h"
+#include "SerializedScriptValue.h"
 #include "qdatetime.h"
 #include "qdebug.h"
+#include "qhash.h"
 #include "qmetaobject.h"
 #include "qmetatype.h"
 #include "qobject.h"
@@ -150,6 +152,16 @@ public:
     }
 };
 
+// Same as above, for the values cloned out of another frame by
+// DumpRenderTreeSupportQt::evaluateFunction.
+class QtDRTSerializedValueRuntime {
+public:
+    static SerializedScriptValue* get(const QDRTSerializedValue& value)
+    {
+        return value.m_value;
+    }
+};
+
 static JSRealType valueRealType(ExecState* exec, JSValue val)
 {
     if (val.isNumber())
@@ -948,6 +960,15 @@ JSValue convertQVariantToValue(ExecState* exec, PassRefPtr<RootObject> root, con
         return toJS(exec, toJSDOMGlobalObject(document, exec), QtDRTNodeRuntime::get(variant.value<QDRTNode>()));
     }
 
+    if (type == qMetaTypeId<QDRTSerializedValue>()) {
+        SerializedScriptValue* value = QtDRTSerializedValueRuntime::get(variant.value<QDRTSerializedValue>());
+        if (!value)
+            return jsUndefined();
+        // Built straight into this frame's objects, in one pass over the buffer
+        JSValue result = value->deserialize(exec, root->globalObject(), NonThrowing);
+        return result ? result : jsUndefined();
+    }
+
     if (type == QMetaType::QVariantMap) {
         // create a new object, and stuff properties into it
         JSObject* ret = constructEmptyObject(exec);
@@ -1025,11 +1046,6 @@ QtRuntimeMethodData::~QtRuntimeMethodData()
 {
 }
 
-QtRuntimeMetaMethodData::~QtRuntimeMetaMethodData()
-{
-
-}
-
 QtRuntimeConnectionMethodData::~QtRuntimeConnectionMethodData()
 {
 
@@ -1160,51 +1176,64 @@ static int indexOfMetaEnum(const QMetaObject *meta, const QByteArray &str)
     return -1;
 }
 
-// Helper function for resolving methods
-// Largely based on code in QtScript for compatibility reasons
-static int findMethodIndex(ExecState* exec,
-                           const QMetaObject* meta,
-                           const QByteArray& signature,
-                           bool allowPrivate,
-                           QVarLengthArray<QVariant, 10> &vars,
-                           void** vvars,
-                           JSObject **pError)
+// A method findMethodIndex can pick for a name, with its return and argument types
+struct QtMethodCandidate
 {
-    QList<int> matchingIndices;
+    int index;
+    QVector<QtMethodMatchType> types;
+    bool unresolvedTypes;
+};
+
+// What findMethodIndex resolves for a QtRuntimeMetaMethod, kept across its calls
+class QtMethodCache
+{
+public:
+    QtMethodCache()
+        : meta(0) { }
+
+    const QMetaObject* meta;
+    QVector<QtMethodCandidate> candidates;
+
+    // Candidate chosen for calls with only primitive arguments, by their types:
+    // converting those only depends on the type, so the choice is the same
+    QHash<QByteArray, int> primitiveCalls;
+};
+
+QtRuntimeMetaMethodData::QtRuntimeMetaMethodData()
+    : m_methodCache(0)
+{
+}
+
+QtRuntimeMetaMethodData::~QtRuntimeMetaMethodData()
+{
+    delete m_methodCache;
+}
+
+static QVector<QtMethodCandidate> resolveMethodCandidates(const QMetaObject* meta,
+                                                          const QByteArray& signature,
+                                                          bool allowPrivate)
+{
+    QVector<QtMethodCandidate> candidates;
 
     bool overloads = !signature.contains('(');
 
     int count = meta->methodCount();
-    for (int i = count - 1; i >= 0; --i) {
-        const QMetaMethod m = meta->method(i);
+    for (int index = count - 1; index >= 0; --index) {
+        const QMetaMethod method = meta->method(index);
 
         // Don't choose private methods
-        if (m.access() == QMetaMethod::Private && !allowPrivate)
+        if (method.access() == QMetaMethod::Private && !allowPrivate)
             continue;
 
         // try and find all matching named methods
-        if (m.signature() == signature)
-            matchingIndices.append(i);
-        else if (overloads) {
-            QByteArray rawsignature = m.signature();
+        if (method.signature() != signature) {
+            if (!overloads)
+                continue;
+            QByteArray rawsignature = method.signature();
             rawsignature.truncate(rawsignature.indexOf('('));
-            if (rawsignature == signature)
-                matchingIndices.append(i);
+            if (rawsignature != signature)
+                continue;
         }
-    }
-
-    int chosenIndex = -1;
-    *pError = 0;
-    QVector<QtMethodMatchType> chosenTypes;
-
-    QVarLengthArray<QVariant, 10> args;
-    QVector<QtMethodMatchData> candidates;
-    QVector<QtMethodMatchData> unresolved;
-    QVector<int> tooFewArgs;
-    QVector<int> conversionFailed;
-
-    foreach(int index, matchingIndices) {
-        QMetaMethod method = meta->method(index);
 
         QVector<QtMethodMatchType> types;
         bool unresolvedTypes = false;
@@ -1258,15 +1287,141 @@ static int findMethodIndex(ExecState* exec,
             }
         }
 
+        QtMethodCandidate candidate;
+        candidate.index = index;
+        candidate.types = types;
+        candidate.unresolvedTypes = unresolvedTypes;
+        candidates.append(candidate);
+    }
+
+    return candidates;
+}
+
+// Types of the arguments, one letter each, if they are all primitives
+static bool primitiveArgumentTypes(ExecState* exec, QByteArray* key)
+{
+    key->resize(exec->argumentCount());
+    for (unsigned i = 0; i < exec->argumentCount(); ++i) {
+        JSValue arg = exec->argument(i);
+        if (arg.isNumber())
+            (*key)[i] = (arg == jsNaN()) ? 'N' : 'n';
+        else if (arg.isString())
+            (*key)[i] = 's';
+        else if (arg.isBoolean())
+            (*key)[i] = 'b';
+        else if (arg.isUndefined())
+            (*key)[i] = 'u';
+        else if (arg.isNull())
+            (*key)[i] = 'l';
+        else
+            return false;
+    }
+    return true;
+}
+
+// Same as convertValueToQVariant, without its set of visited objects for
+// the exact matches of primitives
+static QVariant convertArgumentToQVariant(ExecState* exec, JSValue arg, QMetaType::Type hint, int* distance)
+{
+    if (hint == QMetaType::QString && arg.isString()) {
+        *distance = 0;
+        UString ustring = arg.toString(exec);
+        return QVariant(QString((const QChar*)ustring.impl()->characters(), ustring.length()));
+    }
+    if (hint == QMetaType::Double && arg.isNumber() && arg != jsNaN()) {
+        *distance = 0;
+        return QVariant(arg.toNumber(exec));
+    }
+    if (hint == QMetaType::Bool && arg.isBoolean()) {
+        *distance = 0;
+        return QVariant(arg.toBoolean(exec));
+    }
+    return convertValueToQVariant(exec, arg, hint, distance);
+}
+
+// Converts the arguments for the method of the given types, returns the match distance or -1
+static int convertArguments(ExecState* exec, const QVector<QtMethodMatchType>& types, QVarLengthArray<QVariant, 10>& args)
+{
+    if (args.count() != types.count())
+        args.resize(types.count());
+
+    QtMethodMatchType retType = types[0];
+    args[0] = QVariant(retType.typeId(), (void *)0); // the return value
+
+    int matchDistance = 0;
+    for (unsigned i = 0; i + 1 < static_cast<unsigned>(types.count()); ++i) {
+        JSValue arg = i < exec->argumentCount() ? exec->argument(i) : jsUndefined();
+
+        int argdistance = -1;
+        QVariant v = convertArgumentToQVariant(exec, arg, types.at(i+1).typeId(), &argdistance);
+        if (argdistance < 0) {
+            qMatchDebug() << "failed to convert argument " << i << "type" << types.at(i+1).typeId() << QMetaType::typeName(types.at(i+1).typeId());
+            return -1;
+        }
+        matchDistance += argdistance;
+        args[i+1] = v;
+    }
+    return matchDistance;
+}
+
+// Helper function for resolving methods
+// Largely based on code in QtScript for compatibility reasons
+static int findMethodIndex(ExecState* exec,
+                           const QMetaObject* meta,
+                           const QByteArray& signature,
+                           bool allowPrivate,
+                           QVarLengthArray<QVariant, 10> &vars,
+                           void** vvars,
+                           JSObject **pError,
+                           QtMethodCache* cache)
+{
+    // Looking the candidates up and resolving their types only depends on
+    // the meta object, so it is done once per method object
+    if (cache->meta != meta) {
+        cache->meta = meta;
+        cache->candidates = resolveMethodCandidates(meta, signature, allowPrivate);
+        cache->primitiveCalls.clear();
+    }
+    const QVector<QtMethodCandidate>& matchingCandidates = cache->candidates;
+
+    bool overloads = !signature.contains('(');
+
+    int chosenIndex = -1;
+    int chosenCandidate = -1;
+    *pError = 0;
+
+    QVarLengthArray<QVariant, 10> args;
+
+    QByteArray argumentTypes;
+    const bool primitiveArguments = primitiveArgumentTypes(exec, &argumentTypes);
+    if (primitiveArguments) {
+        QHash<QByteArray, int>::const_iterator cached = cache->primitiveCalls.constFind(argumentTypes);
+        if (cached != cache->primitiveCalls.constEnd()
+            && convertArguments(exec, matchingCandidates.at(cached.value()).types, args) >= 0) {
+            chosenCandidate = cached.value();
+            chosenIndex = matchingCandidates.at(chosenCandidate).index;
+        }
+    }
+
+    QVector<QtMethodMatchData> candidates;
+    QVector<QtMethodMatchData> unresolved;
+    QVector<int> tooFewArgs;
+    QVector<int> conversionFailed;
+
+    for (int c = 0; chosenIndex == -1 && c < matchingCandidates.count(); ++c) {
+        const QtMethodCandidate& candidate = matchingCandidates.at(c);
+        int index = candidate.index;
+        const QVector<QtMethodMatchType>& types = candidate.types;
+
         // If the native method requires more arguments than what was passed from JavaScript
         if (exec->argumentCount() + 1 < static_cast<unsigned>(types.count())) {
-            qMatchDebug() << "Match:too few args for" << method.signature();
+            qMatchDebug() << "Match:too few args for" << meta->method(index).signature();
             tooFewArgs.append(index);
             continue;
         }
 
-        if (unresolvedTypes) {
-            qMatchDebug() << "Match:unresolved arg types for" << method.signature();
+        if (candidate.unresolvedTypes) {
+            qMatchDebug() << "Match:unresolved arg types for" << meta->method(index).signature();
             // remember it so we can give an error message later, if necessary
             unresolved.append(QtMethodMatchData(/*matchDistance=*/INT_MAX, index,
                                                    types, QVarLengthArray<QVariant, 10>()));
@@ -1274,35 +1429,17 @@ static int findMethodIndex(ExecState* exec,
         }
 
         // Now convert arguments
-        if (args.count() != types.count())
-            args.resize(types.count());
-
-        QtMethodMatchType retType = types[0];
-        args[0] = QVariant(retType.typeId(), (void *)0); // the return value
-
-        bool converted = true;
-        int matchDistance = 0;
-        for (unsigned i = 0; converted && i + 1 < static_cast<unsigned>(types.count()); ++i) {
-            JSValue arg = i < exec->argumentCount() ? exec->argument(i) : jsUndefined();
-
-            int argdistance = -1;
-            QVariant v = convertValueToQVariant(exec, arg, types.at(i+1).typeId(), &argdistance);
-            if (argdistance >= 0) {
-                matchDistance += argdistance;
-                args[i+1] = v;
-            } else {
-                qMatchDebug() << "failed to convert argument " << i << "type" << types.at(i+1).typeId() << QMetaType::typeName(types.at(i+1).typeId());
-                converted = false;
-            }
-        }
+        int matchDistance = convertArguments(exec, types, args);
+        bool converted = matchDistance >= 0;
 
-        qMatchDebug() << "Match: " << method.signature() << (converted ? "converted":"failed to convert") << "distance " << matchDistance;
+        qMatchDebug() << "Match: " << meta->method(index).signature() << (converted ? "converted":"failed to convert") << "distance " << matchDistance;
 
         if (converted) {
             if ((exec->argumentCount() + 1 == static_cast<unsigned>(types.count()))
                 && (matchDistance == 0)) {
                 // perfect match, use this one
                 chosenIndex = index;
+                chosenCandidate = c;
                 break;
             } else {
                 QtMethodMatchData currentMatch(matchDistance, index, types, args);
@@ -1386,6 +1523,13 @@ static int findMethodIndex(ExecState* exec,
         }
     }
 
+    if (chosenIndex != -1 && primitiveArguments) {
+        if (chosenCandidate == -1) {
+            for (chosenCandidate = 0; matchingCandidates.at(chosenCandidate).index != chosenIndex; ++chosenCandidate) { }
+        }
+        cache->primitiveCalls.insert(argumentTypes, chosenCandidate);
+    }
+
     if (chosenIndex != -1) {
         /* Copy the stuff over */
         int i;
@@ -1451,7 +1595,9 @@ EncodedJSValue QtRuntimeMetaMethod::call(ExecState* exec)
 
         int methodIndex;
         JSObject* errorObj = 0;
-        if ((methodIndex = findMethodIndex(exec, obj->metaObject(), d->m_signature, d->m_allowPrivate, vargs, (void **)qargs, &errorObj)) != -1) {
+        if (!d->m_methodCache)
+            d->m_methodCache = new QtMethodCache;
+        if ((methodIndex = findMethodIndex(exec, obj->metaObject(), d->m_signature, d->m_allowPrivate, vargs, (void **)qargs, &errorObj, d->m_methodCache)) != -1) {
             if (QMetaObject::metacall(obj, QMetaObject::InvokeMetaMethod, methodIndex, qargs) >= 0)
                 return JSValue::encode(jsUndefined());
 
@@ -123,12 +123,15 @@ class QtRuntimeMethodData {
 };
 
 class QtRuntimeConnectionMethod;
+class QtMethodCache;
 class QtRuntimeMetaMethodData : public QtRuntimeMethodData {
     public:
+        QtRuntimeMetaMethodData();
         ~QtRuntimeMetaMethodData();
         QByteArray m_signature;
         bool m_allowPrivate;
         int m_index;
+        QtMethodCache* m_methodCache; // overload resolution kept across calls
         WriteBarrier<QtRuntimeConnectionMethod> m_connect;
         WriteBarrier<QtRuntimeConnectionMethod> m_disconnect;
 };
@@ -38,6 +38,7 @@
 #include "HTMLParserIdioms.h"
 #include "MediaList.h"
 #include "MediaQueryEvaluator.h"
+#include "ResourceHandle.h"
 
 namespace WebCore {
 
@@ -125,6 +126,10 @@ public:
         if (m_urlToLoad.isEmpty())
             return;
 
+        // Start resolving the host now: preloads found while scanning the body
+        // are only requested once the parser gets there.
+        ResourceHandle::prepareForURL(document->completeURL(m_urlToLoad));
+
         CachedResourceLoader* cachedResourceLoader = document->cachedResourceLoader();
         if (m_tagName == scriptTag)
             cachedResourceLoader->preload(CachedResource::Script, m_urlToLoad, m_charset, scanningBody);
@@ -21,6 +21,7 @@
 
 #include <QObject>
 #include <QCache>
+#include <QHash>
 #include <QHostInfo>
 #include <QSet>
 #include <QString>
@@ -32,31 +33,33 @@ namespace WebCore {
     class DnsPrefetchHelper : public QObject {
         Q_OBJECT
     public:
-        DnsPrefetchHelper() : QObject(), currentLookups(0) { }
+        DnsPrefetchHelper() : QObject() { }
 
     public slots:
         void lookup(QString hostname)
         {
             if (hostname.isEmpty())
                 return; // this actually happens
-            if (currentLookups >= 10)
+            if (pendingLookups.contains(hostname))
+                return; // a page references the same hosts over and over
+            if (pendingLookups.size() >= 10)
                 return; // do not launch more than 10 lookups at the same time
 
-            currentLookups++;
-            QHostInfo::lookupHost(hostname, this, SLOT(lookedUp(QHostInfo)));
+            pendingLookups.insert(hostname);
+            lookupIds.insert(QHostInfo::lookupHost(hostname, this, SLOT(lookedUp(QHostInfo))), hostname);
         }
 
-        void lookedUp(const QHostInfo&)
+        void lookedUp(const QHostInfo& info)
         {
             // we do not cache the result, we throw it away.
-            // we currently rely on the OS to cache the results. If it does not do that
-            // then at least the ISP nameserver did it.
-            // Since Qt 4.6.3, Qt also has a small DNS cache.
-            currentLookups--;
+            // The Qt DNS cache keeps it (see QHostInfoCache), and the OS
+            // or at least the ISP nameserver too.
+            pendingLookups.remove(lookupIds.take(info.lookupId()));
         }
 
     protected:
-        int currentLookups;
+        QSet<QString> pendingLookups;
+        QHash<int, QString> lookupIds;
     };
 
 
@@ -40,9 +40,17 @@
 #include "texmap/TextureMapper.h"
 #endif
 
+#if USE(JSC)
+#include <heap/Strong.h>
+#include <runtime/JSObject.h>
+#include <wtf/HashMap.h>
+#include <wtf/text/StringHash.h>
+#endif
+
 
 namespace WebCore {
     class FrameLoaderClientQt;
+    class JSDOMWindow;
     class FrameView;
     class HTMLFrameOwnerElement;
     class Scrollbar;
@@ -83,6 +91,9 @@ public:
         , marginHeight(-1)
 #if USE(ACCELERATED_COMPOSITING) && USE(TEXTURE_MAPPER)
         , rootGraphicsLayer(0)
+#endif
+#if USE(JSC)
+        , compiledFunctionsWindow(0)
 #endif
         {}
     void init(QWebFrame* qframe, QWebFrameData* frameData);
@@ -129,6 +140,13 @@ public:
 #if ENABLE(ORIENTATION_EVENTS) && ENABLE(DEVICE_ORIENTATION)
     QtMobility::QOrientationSensor m_orientation;
 #endif
+
+#if USE(JSC)
+    // Functions compiled by DumpRenderTreeSupportQt::evaluateFunction, by
+    // source, for the window object they were compiled in
+    WTF::HashMap<WTF::String, JSC::Strong<JSC::JSObject> > compiledFunctions;
+    WebCore::JSDOMWindow* compiledFunctionsWindow;
+#endif
 };
 
 class QWebHitTestResultPrivate {
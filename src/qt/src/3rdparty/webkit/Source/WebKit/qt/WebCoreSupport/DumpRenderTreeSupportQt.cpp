@@ -58,9 +58,15 @@
 #include "HTMLInputElement.h"
 #include "InputElement.h"
 #include "InspectorController.h"
+#if USE(JSC)
+#include "JSDOMWindow.h"
+#include "JSMainThreadExecState.h"
+#endif
+#include "MemoryCache.h"
 #include "NodeList.h"
 #include "NotificationPresenterClientQt.h"
 #include "Page.h"
+#include "PageCache.h"
 #include "PageGroup.h"
 #include "PluginDatabase.h"
 #include "PositionError.h"
@@ -69,8 +75,10 @@
 #include "RenderTreeAsText.h"
 #include "ShadowRoot.h"
 #include "ScriptController.h"
+#include "ScriptSourceCode.h"
 #include "ScriptValue.h"
 #include "SecurityOrigin.h"
+#include "SerializedScriptValue.h"
 #include "Settings.h"
 #if ENABLE(SVG)
 #include "SVGDocumentExtensions.h"
@@ -89,6 +97,10 @@
 #include "qwebpage.h"
 #include "qwebpage_p.h"
 #include "qwebscriptworld.h"
+#if USE(JSC)
+#include "qt_runtime.h"
+#include "runtime_root.h"
+#endif
 
 #if ENABLE(VIDEO) && USE(QT_MULTIMEDIA)
 #include "HTMLVideoElement.h"
@@ -147,6 +159,44 @@ QDRTNode& QDRTNode::operator=(const QDRTNode& other)
     return *this;
 }
 
+QDRTSerializedValue::QDRTSerializedValue()
+    : m_value(0)
+{
+}
+
+QDRTSerializedValue::QDRTSerializedValue(WebCore::SerializedScriptValue* value)
+    : m_value(value)
+{
+    if (m_value)
+        m_value->ref();
+}
+
+QDRTSerializedValue::~QDRTSerializedValue()
+{
+    if (m_value)
+        m_value->deref();
+}
+
+QDRTSerializedValue::QDRTSerializedValue(const QDRTSerializedValue& other)
+    : m_value(other.m_value)
+{
+    if (m_value)
+        m_value->ref();
+}
+
+QDRTSerializedValue& QDRTSerializedValue::operator=(const QDRTSerializedValue& other)
+{
+    if (this != &other) {
+        SerializedScriptValue* otherValue = other.m_value;
+        if (otherValue)
+            otherValue->ref();
+        if (m_value)
+            m_value->deref();
+        m_value = otherValue;
+    }
+    return *this;
+}
+
 
 DumpRenderTreeSupportQt::DumpRenderTreeSupportQt()
 {
@@ -392,6 +442,58 @@ int DumpRenderTreeSupportQt::javaScriptObjectsCount()
 #endif
 }
 
+QVariantMap DumpRenderTreeSupportQt::javaScriptHeapStatistics()
+{
+    QVariantMap statistics;
+#if USE(JSC)
+    JSC::Heap& heap = JSDOMWindowBase::commonJSGlobalData()->heap;
+    statistics.insert(QLatin1String("size"), static_cast<qulonglong>(heap.size()));
+    statistics.insert(QLatin1String("capacity"), static_cast<qulonglong>(heap.capacity()));
+    statistics.insert(QLatin1String("objectCount"), static_cast<qulonglong>(heap.objectCount()));
+    statistics.insert(QLatin1String("globalObjectCount"), static_cast<qulonglong>(heap.globalObjectCount()));
+    statistics.insert(QLatin1String("protectedObjectCount"), static_cast<qulonglong>(heap.protectedObjectCount()));
+    statistics.insert(QLatin1String("collectionCount"), static_cast<qulonglong>(heap.collectionCount()));
+    statistics.insert(QLatin1String("collectionTime"), heap.collectionTime() * 1000);
+#endif
+    return statistics;
+}
+
+static QVariantMap memoryCacheTypeStatistics(const MemoryCache::TypeStatistic& statistic)
+{
+    QVariantMap map;
+    map.insert(QLatin1String("count"), statistic.count);
+    map.insert(QLatin1String("size"), statistic.size);
+    map.insert(QLatin1String("liveSize"), statistic.liveSize);
+    map.insert(QLatin1String("decodedSize"), statistic.decodedSize);
+    return map;
+}
+
+QVariantMap DumpRenderTreeSupportQt::memoryCacheStatistics()
+{
+    const MemoryCache::Statistics statistics = memoryCache()->getStatistics();
+
+    QVariantMap pages;
+    pages.insert(QLatin1String("count"), pageCache()->pageCount());
+    pages.insert(QLatin1String("capacity"), pageCache()->capacity());
+
+    QVariantMap capacities;
+    capacities.insert(QLatin1String("size"), memoryCache()->capacity());
+    capacities.insert(QLatin1String("minDeadSize"), memoryCache()->minDeadCapacity());
+    capacities.insert(QLatin1String("maxDeadSize"), memoryCache()->maxDeadCapacity());
+
+    QVariantMap map;
+    map.insert(QLatin1String("images"), memoryCacheTypeStatistics(statistics.images));
+    map.insert(QLatin1String("cssStyleSheets"), memoryCacheTypeStatistics(statistics.cssStyleSheets));
+    map.insert(QLatin1String("scripts"), memoryCacheTypeStatistics(statistics.scripts));
+#if ENABLE(XSLT)
+    map.insert(QLatin1String("xslStyleSheets"), memoryCacheTypeStatistics(statistics.xslStyleSheets));
+#endif
+    map.insert(QLatin1String("fonts"), memoryCacheTypeStatistics(statistics.fonts));
+    map.insert(QLatin1String("pageCache"), pages);
+    map.insert(QLatin1String("capacities"), capacities);
+    return map;
+}
+
 void DumpRenderTreeSupportQt::garbageCollectorCollect()
 {
 #if USE(JSC)
@@ -898,6 +1000,113 @@ void DumpRenderTreeSupportQt::clearScriptWorlds()
     m_worldMap.clear();
 }
 
+#if USE(JSC)
+// Past this many distinct functions in a frame, the compiled ones are dropped
+static const unsigned maxCompiledFunctionsPerFrame = 256;
+
+// Unlike convertQVariantToValue, makes real arrays out of lists and keeps
+// undefined, so arguments look the same as if written in the page
+static JSC::JSValue convertArgumentToValue(JSC::ExecState* exec, JSC::Bindings::RootObject* root, const QVariant& argument)
+{
+    if (!argument.isValid())
+        return JSC::jsUndefined();
+
+    if (argument.userType() == QMetaType::QVariantList || argument.userType() == QMetaType::QStringList) {
+        const QVariantList list = argument.toList();
+        JSC::MarkedArgumentBuffer values;
+        for (int i = 0; i < list.size(); ++i)
+            values.append(convertArgumentToValue(exec, root, list.at(i)));
+        return JSC::constructArray(exec, values);
+    }
+
+    if (argument.userType() == QMetaType::QVariantMap) {
+        JSC::JSObject* object = JSC::constructEmptyObject(exec);
+        const QVariantMap map = argument.toMap();
+        for (QVariantMap::const_iterator i = map.constBegin(); i != map.constEnd(); ++i) {
+            JSC::PutPropertySlot slot;
+            object->put(exec, JSC::Identifier(exec, reinterpret_cast_ptr<const UChar*>(i.key().constData()), i.key().length()),
+                        convertArgumentToValue(exec, root, i.value()), slot);
+        }
+        return object;
+    }
+
+    return JSC::Bindings::convertQVariantToValue(exec, root, argument);
+}
+#endif
+
+QVariant DumpRenderTreeSupportQt::evaluateFunction(QWebFrame* frame, const QString& source, const QVariantList& arguments, const QString& location, bool serialized)
+{
+    QVariant rc;
+#if USE(JSC)
+    WebCore::Frame* coreFrame = QWebFramePrivate::core(frame);
+    ScriptController* proxy = coreFrame->script();
+    if (!proxy || !proxy->canExecuteScripts(AboutToExecuteScript) || proxy->isPaused())
+        return rc;
+
+    QWebFramePrivate* d = frame->d;
+    RefPtr<WebCore::Frame> protect(coreFrame);
+    JSC::JSLock lock(JSC::SilenceAssertionsOnly);
+    JSDOMWindowShell* shell = proxy->windowShell(mainThreadNormalWorld());
+    JSDOMWindow* window = shell->window();
+    JSC::ExecState* exec = window->globalExec();
+
+    if (d->compiledFunctionsWindow != window || d->compiledFunctions.size() >= maxCompiledFunctionsPerFrame) {
+        d->compiledFunctions.clear();
+        d->compiledFunctionsWindow = window;
+    }
+
+    // Compile each distinct function once, then only call it
+    const WTF::String functionSource(source);
+    JSC::JSObject* function = 0;
+    WTF::HashMap<WTF::String, JSC::Strong<JSC::JSObject> >::iterator compiled = d->compiledFunctions.find(functionSource);
+    if (compiled != d->compiledFunctions.end())
+        function = compiled->second.get();
+    if (!function) {
+        JSC::JSValue value = proxy->executeScript(ScriptSourceCode("(" + functionSource + ")", WTF::String(location))).jsValue();
+        if (!value.isObject())
+            return rc;
+        function = asObject(value);
+        d->compiledFunctions.set(functionSource, JSC::Strong<JSC::JSObject>(exec->globalData(), function));
+    }
+
+    JSC::CallData callData;
+    JSC::CallType callType = JSC::getCallData(function, callData);
+    if (callType == JSC::CallTypeNone)
+        return rc;
+
+    // Arguments go through the Qt bridge as values, not as source text
+    RefPtr<JSC::Bindings::RootObject> root = proxy->bindingRootObject();
+    JSC::MarkedArgumentBuffer args;
+    for (int i = 0; i < arguments.size(); ++i)
+        args.append(convertArgumentToValue(exec, root.get(), arguments.at(i)));
+
+    exec->globalData().timeoutChecker.start();
+    JSC::JSValue result = JSMainThreadExecState::call(exec, function, callType, callData, shell, args);
+    exec->globalData().timeoutChecker.stop();
+    Document::updateStyleForAllDocuments();
+
+    if (exec->hadException()) {
+        reportException(exec, exec->exception());
+        exec->clearException();
+        return rc;
+    }
+
+    // Cloned in one pass into a flat buffer; values that cannot be cloned
+    // (functions, host objects) take the QVariant conversion below
+    if (serialized) {
+        RefPtr<SerializedScriptValue> value = SerializedScriptValue::create(exec, result, NonThrowing);
+        if (exec->hadException())
+            exec->clearException();
+        if (value)
+            return QVariant::fromValue(QDRTSerializedValue(value.get()));
+    }
+
+    int distance = 0;
+    rc = JSC::Bindings::convertValueToQVariant(exec, result, QMetaType::Void, &distance);
+#endif
+    return rc;
+}
+
 void DumpRenderTreeSupportQt::evaluateScriptInIsolatedWorld(QWebFrame* frame, int worldID, const QString& script)
 {
     QWebScriptWorld* scriptWorld;
@@ -1188,6 +1397,26 @@ int QWEBKIT_EXPORT qt_drt_javaScriptObjectsCount()
     return DumpRenderTreeSupportQt::javaScriptObjectsCount();
 }
 
+QVariantMap QWEBKIT_EXPORT qt_drt_javaScriptHeapStatistics()
+{
+    return DumpRenderTreeSupportQt::javaScriptHeapStatistics();
+}
+
+QVariantMap QWEBKIT_EXPORT qt_drt_memoryCacheStatistics()
+{
+    return DumpRenderTreeSupportQt::memoryCacheStatistics();
+}
+
+QVariant QWEBKIT_EXPORT qt_drt_evaluateFunction(QWebFrame* frame, const QString& source, const QVariantList& arguments, const QString& location)
+{
+    return DumpRenderTreeSupportQt::evaluateFunction(frame, source, arguments, location);
+}
+
+QVariant QWEBKIT_EXPORT qt_drt_evaluateFunctionSerialized(QWebFrame* frame, const QString& source, const QVariantList& arguments, const QString& location)
+{
+    return DumpRenderTreeSupportQt::evaluateFunction(frame, source, arguments, location, true);
+}
+
 int QWEBKIT_EXPORT qt_drt_numberOfActiveAnimations(QWebFrame* frame)
 {
     return DumpRenderTreeSupportQt::numberOfActiveAnimations(frame);
@@ -29,6 +29,7 @@
 namespace WebCore {
 class Text;
 class Node;
+class SerializedScriptValue;
 }
 
 
@@ -36,12 +37,14 @@ class Node;
 namespace V8 {
 namespace Bindings {
 class QtDRTNodeRuntime;
+class QtDRTSerializedValueRuntime;
 }
 }
 #else
 namespace JSC {
 namespace Bindings {
 class QtDRTNodeRuntime;
+class QtDRTSerializedValueRuntime;
 }
 }
 #endif
@@ -82,6 +85,31 @@ private:
 
 Q_DECLARE_METATYPE(QDRTNode)
 
+// Carries a structured clone of a script value to another frame, which
+// rebuilds it as script objects without going through QVariant trees
+class QWEBKIT_EXPORT QDRTSerializedValue {
+public:
+    QDRTSerializedValue();
+    QDRTSerializedValue(const QDRTSerializedValue&);
+    QDRTSerializedValue &operator=(const QDRTSerializedValue&);
+    ~QDRTSerializedValue();
+
+private:
+    explicit QDRTSerializedValue(WebCore::SerializedScriptValue*);
+
+    friend class DumpRenderTreeSupportQt;
+
+#if defined(WTF_USE_V8) && WTF_USE_V8
+    friend class V8::Bindings::QtDRTSerializedValueRuntime;
+#else
+    friend class JSC::Bindings::QtDRTSerializedValueRuntime;
+#endif
+
+    WebCore::SerializedScriptValue* m_value;
+};
+
+Q_DECLARE_METATYPE(QDRTSerializedValue)
+
 class QWEBKIT_EXPORT DumpRenderTreeSupportQt {
 
 public:
@@ -118,8 +146,11 @@ public:
     static void setJavaScriptProfilingEnabled(QWebFrame*, bool enabled);
     static void setValueForUser(const QWebElement&, const QString& value);
     static int javaScriptObjectsCount();
+    static QVariantMap javaScriptHeapStatistics();
+    static QVariantMap memoryCacheStatistics();
     static void clearScriptWorlds();
     static void evaluateScriptInIsolatedWorld(QWebFrame* frame, int worldID, const QString& script);
+    static QVariant evaluateFunction(QWebFrame* frame, const QString& source, const QVariantList& arguments, const QString& location, bool serialized = false);
 
     static void setTimelineProfilingEnabled(QWebPage*, bool enabled);
     static void webInspectorExecuteScript(QWebPage* page, long callId, const QString& script);
@@ -753,6 +753,14 @@ void FrameLoaderClientQt::dispatchDidClearWindowObjectInWorld(DOMWrapperWorld* w
     if (world != mainThreadNormalWorld())
         return;
 
+#if USE(JSC)
+    // Functions compiled for the previous window object would keep it alive
+    if (m_webFrame) {
+        m_webFrame->d->compiledFunctions.clear();
+        m_webFrame->d->compiledFunctionsWindow = 0;
+    }
+#endif
+
     if (m_webFrame)
         emit m_webFrame->javaScriptWindowObjectCleared();
 }
@@ -84,7 +84,8 @@ const int QHttpNetworkConnectionPrivate::defaultRePipelineLength = 2;
 QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(const QString &hostName, quint16 port, bool encrypt)
 : state(RunningState),
   hostName(hostName), port(port), encrypt(encrypt),
-  channelCount(defaultChannelCount)
+  channelCount(defaultChannelCount),
+  pipelineLength(defaultPipelineLength), rePipelineLength(defaultRePipelineLength)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
@@ -95,7 +96,8 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(const QString &host
 QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(quint16 channelCount, const QString &hostName, quint16 port, bool encrypt)
 : state(RunningState),
   hostName(hostName), port(port), encrypt(encrypt),
-  channelCount(channelCount)
+  channelCount(channelCount),
+  pipelineLength(defaultPipelineLength), rePipelineLength(defaultRePipelineLength)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
@@ -572,7 +574,7 @@ void QHttpNetworkConnectionPrivate::fillPipeline(QAbstractSocket *socket)
     if (channels[i].reply == 0)
         return;
 
-    if (! (defaultPipelineLength - channels[i].alreadyPipelinedRequests.length() >= defaultRePipelineLength)) {
+    if (! (pipelineLength - channels[i].alreadyPipelinedRequests.length() >= rePipelineLength)) {
         return;
     }
 
@@ -616,7 +618,7 @@ void QHttpNetworkConnectionPrivate::fillPipeline(QAbstractSocket *socket)
         lengthBefore = channels[i].alreadyPipelinedRequests.length();
         fillPipeline(highPriorityQueue, channels[i]);
 
-        if (channels[i].alreadyPipelinedRequests.length() >= defaultPipelineLength) {
+        if (channels[i].alreadyPipelinedRequests.length() >= pipelineLength) {
             channels[i].pipelineFlush();
             return;
         }
@@ -629,7 +631,7 @@ void QHttpNetworkConnectionPrivate::fillPipeline(QAbstractSocket *socket)
         lengthBefore = channels[i].alreadyPipelinedRequests.length();
         fillPipeline(lowPriorityQueue, channels[i]);
 
-        if (channels[i].alreadyPipelinedRequests.length() >= defaultPipelineLength) {
+        if (channels[i].alreadyPipelinedRequests.length() >= pipelineLength) {
             channels[i].pipelineFlush();
             return;
         }
@@ -942,6 +944,27 @@ QHttpNetworkConnectionChannel *QHttpNetworkConnection::channels() const
     return d_func()->channels;
 }
 
+int QHttpNetworkConnection::channelCount() const
+{
+    return d_func()->channelCount;
+}
+
+// The pipeline is only re-filled once a channel has at least
+// (length - 1) free slots, like the default of 3 and 2.
+void QHttpNetworkConnection::setPipelineLength(int length)
+{
+    Q_D(QHttpNetworkConnection);
+    if (length < 1)
+        length = QHttpNetworkConnectionPrivate::defaultPipelineLength;
+    d->pipelineLength = length;
+    d->rePipelineLength = qMax(1, length - 1);
+}
+
+int QHttpNetworkConnection::pipelineLength() const
+{
+    return d_func()->pipelineLength;
+}
+
 #ifndef QT_NO_NETWORKPROXY
 void QHttpNetworkConnection::setCacheProxy(const QNetworkProxy &networkProxy)
 {
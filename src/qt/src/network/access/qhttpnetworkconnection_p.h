@@ -117,6 +117,12 @@ public:
     bool isSsl() const;
 
     QHttpNetworkConnectionChannel *channels() const;
+    //number of parallel connections to the server
+    int channelCount() const;
+
+    //maximum number of requests pipelined on one channel
+    void setPipelineLength(int length);
+    int pipelineLength() const;
 
 #ifndef QT_NO_OPENSSL
     void setSslConfiguration(const QSslConfiguration &config);
@@ -199,6 +205,9 @@ public:
     const int channelCount;
     QHttpNetworkConnectionChannel *channels; // parallel connections to the server
 
+    int pipelineLength;
+    int rePipelineLength;
+
     qint64 uncompressedBytesAvailable(const QHttpNetworkReply &reply) const;
     qint64 uncompressedBytesAvailableNextBlock(const QHttpNetworkReply &reply) const;
 
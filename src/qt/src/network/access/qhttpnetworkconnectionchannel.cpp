@@ -80,6 +80,11 @@ QHttpNetworkConnectionChannel::QHttpNetworkConnectionChannel()
 #ifndef QT_NO_OPENSSL
     , ignoreAllSslErrors(false)
 #endif
+    , dnsTime(-1)
+    , connectTime(-1)
+    , sslTime(-1)
+    , sslResumed(false)
+    , connectTimingsPending(false)
     , pipeliningSupported(PipeliningSupportUnknown)
     , connection(0)
 {
@@ -110,6 +115,9 @@ void QHttpNetworkConnectionChannel::init()
     QObject::connect(socket, SIGNAL(bytesWritten(qint64)),
                      this, SLOT(_q_bytesWritten(qint64)),
                      Qt::DirectConnection);
+    QObject::connect(socket, SIGNAL(hostFound()),
+                     this, SLOT(_q_hostFound()),
+                     Qt::DirectConnection);
     QObject::connect(socket, SIGNAL(connected()),
                      this, SLOT(_q_connected()),
                      Qt::DirectConnection);
@@ -194,6 +202,12 @@ bool QHttpNetworkConnectionChannel::sendRequest()
         replyPrivate->autoDecompress = request.d->autoDecompress;
         replyPrivate->pipeliningUsed = false;
 
+        takeConnectTimings(reply);
+        replyPrivate->sendStart = replyPrivate->elapsed();
+        replyPrivate->sendEnd = -1;
+        replyPrivate->waitEnd = -1;
+        replyPrivate->receiveEnd = -1;
+
         // if the url contains authentication parameters, use the new ones
         // both channels will use the new authentication parameters
         if (!request.url().userInfo().isEmpty() && request.withCredentials()) {
@@ -305,6 +319,10 @@ bool QHttpNetworkConnectionChannel::sendRequest()
 
     case QHttpNetworkConnectionChannel::WaitingState:
     {
+        // the whole request has been handed to the socket
+        if (reply->d_func()->sendEnd < 0)
+            reply->d_func()->sendEnd = reply->d_func()->elapsed();
+
         QNonContiguousByteDevice* uploadByteDevice = request.uploadByteDevice();
         if (uploadByteDevice) {
             QObject::disconnect(uploadByteDevice, SIGNAL(readyRead()), this, SLOT(_q_uploadDataReadyRead()));
@@ -379,6 +397,8 @@ void QHttpNetworkConnectionChannel::_q_receiveReply()
         QHttpNetworkReplyPrivate::ReplyState state = reply->d_func()->state;
         switch (state) {
         case QHttpNetworkReplyPrivate::NothingDoneState: {
+            // first byte of the response
+            reply->d_func()->waitEnd = reply->d_func()->elapsed();
             state = reply->d_func()->state = QHttpNetworkReplyPrivate::ReadingStatusState;
             // fallthrough
         }
@@ -556,6 +576,13 @@ bool QHttpNetworkConnectionChannel::ensureConnection()
         state = QHttpNetworkConnectionChannel::ConnectingState;
         pendingEncrypt = ssl;
 
+        connectTimer.start();
+        dnsTime = -1;
+        connectTime = -1;
+        sslTime = -1;
+        sslResumed = false;
+        connectTimingsPending = true;
+
         // reset state
         pipeliningSupported = PipeliningSupportUnknown;
         authenticationCredentialsSent = false;
@@ -702,6 +729,8 @@ void QHttpNetworkConnectionChannel::allDone()
         return;
     }
 
+    reply->d_func()->receiveEnd = reply->d_func()->elapsed();
+
     // while handling 401 & 407, we might reset the status code, so save this.
     bool emitFinished = reply->d_func()->shouldEmitSignals();
     bool connectionCloseEnabled = reply->d_func()->isConnectionCloseEnabled();
@@ -893,6 +922,8 @@ void QHttpNetworkConnectionChannel::pipelineInto(HttpMessagePair &pair)
     reply->d_func()->connectionChannel = this;
     reply->d_func()->autoDecompress = request.d->autoDecompress;
     reply->d_func()->pipeliningUsed = true;
+    reply->d_func()->sendStart = reply->d_func()->elapsed();
+    reply->d_func()->sendEnd = reply->d_func()->sendStart;
 
 #ifndef QT_NO_NETWORKPROXY
     pipeline.append(QHttpNetworkRequestPrivate::header(request,
@@ -1011,6 +1042,25 @@ void QHttpNetworkConnectionChannel::_q_disconnected()
 }
 
 
+void QHttpNetworkConnectionChannel::_q_hostFound()
+{
+    dnsTime = connectTimer.nsecsElapsed() / 1000;
+}
+
+void QHttpNetworkConnectionChannel::takeConnectTimings(QHttpNetworkReply *reply)
+{
+    // only the first request sent on a new connection paid for its setup,
+    // the ones reusing it keep -1
+    if (connectTimingsPending) {
+        QHttpNetworkReplyPrivate *replyPrivate = reply->d_func();
+        replyPrivate->dnsTime = dnsTime;
+        replyPrivate->connectTime = connectTime;
+        replyPrivate->sslTime = sslTime;
+        replyPrivate->sslResumed = sslResumed;
+        connectTimingsPending = false;
+    }
+}
+
 void QHttpNetworkConnectionChannel::_q_connected()
 {
     // improve performance since we get the request sent by the kernel ASAP
@@ -1025,6 +1075,8 @@ void QHttpNetworkConnectionChannel::_q_connected()
     // not sure yet if it helps, but it makes sense
     socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
 
+    connectTime = connectTimer.nsecsElapsed() / 1000 - qMax(dnsTime, qint64(0));
+
     pipeliningSupported = QHttpNetworkConnectionChannel::PipeliningSupportUnknown;
 
     // ### FIXME: if the server closes the connection unexpectedly, we shouldn't send the same broken request again!
@@ -1138,6 +1190,8 @@ void QHttpNetworkConnectionChannel::_q_encrypted()
         return; // ### error
     state = QHttpNetworkConnectionChannel::IdleState;
     pendingEncrypt = false;
+    sslTime = connectTimer.nsecsElapsed() / 1000 - qMax(dnsTime, qint64(0)) - qMax(connectTime, qint64(0));
+    sslResumed = socket->property("_q_sslSessionResumed").toBool();
     if (!reply)
         connection->d_func()->dequeueRequest(socket);
     if (reply)
@@ -60,6 +60,7 @@
 #include <qauthenticator.h>
 #include <qnetworkproxy.h>
 #include <qbuffer.h>
+#include <qelapsedtimer.h>
 
 #include <private/qhttpnetworkheader_p.h>
 #include <private/qhttpnetworkrequest_p.h>
@@ -123,6 +124,16 @@ public:
     QSharedPointer<QNetworkSession> networkSession;
 #endif
 
+    // Connection setup timings (microseconds), handed to the first reply sent
+    // on a new connection; -1 if a phase did not happen
+    QElapsedTimer connectTimer;
+    qint64 dnsTime;
+    qint64 connectTime;
+    qint64 sslTime;
+    bool sslResumed; // The handshake resumed a previous SSL session
+    bool connectTimingsPending;
+    void takeConnectTimings(QHttpNetworkReply *reply);
+
     // HTTP pipelining -> http://en.wikipedia.org/wiki/Http_pipelining
     enum PipeliningSupport {
         PipeliningSupportUnknown, // default for a new connection
@@ -170,6 +181,7 @@ public:
     void _q_bytesWritten(qint64 bytes); // proceed sending
     void _q_readyRead(); // pending data to read
     void _q_disconnected(); // disconnected from host
+    void _q_hostFound(); // host lookup done, now connecting
     void _q_connected(); // start sending request
     void _q_error(QAbstractSocket::SocketError); // error from socket
 #ifndef QT_NO_NETWORKPROXY
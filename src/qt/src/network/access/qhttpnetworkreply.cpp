@@ -237,6 +237,35 @@ bool QHttpNetworkReply::isPipeliningUsed() const
     return d_func()->pipeliningUsed;
 }
 
+QVariantMap QHttpNetworkReply::timings() const
+{
+    Q_D(const QHttpNetworkReply);
+    QVariantMap timings;
+
+    // time spent waiting for a channel, excluding the connection setup
+    qint64 blocked = -1;
+    if (d->sendStart >= 0) {
+        blocked = d->sendStart - qMax(d->dnsTime, qint64(0))
+                               - qMax(d->connectTime, qint64(0))
+                               - qMax(d->sslTime, qint64(0));
+        blocked = qMax(blocked, qint64(0));
+    }
+
+    timings.insert(QLatin1String("blocked"), blocked);
+    timings.insert(QLatin1String("dns"), d->dnsTime);
+    timings.insert(QLatin1String("connect"), d->connectTime);
+    timings.insert(QLatin1String("ssl"), d->sslTime);
+    if (d->sslTime >= 0)
+        timings.insert(QLatin1String("sslResumed"), d->sslResumed);
+    timings.insert(QLatin1String("send"),
+                   (d->sendStart >= 0 && d->sendEnd >= 0) ? d->sendEnd - d->sendStart : qint64(-1));
+    timings.insert(QLatin1String("wait"),
+                   (d->sendEnd >= 0 && d->waitEnd >= 0) ? qMax(d->waitEnd - d->sendEnd, qint64(0)) : qint64(-1));
+    timings.insert(QLatin1String("receive"),
+                   (d->waitEnd >= 0 && d->receiveEnd >= 0) ? d->receiveEnd - d->waitEnd : qint64(-1));
+    return timings;
+}
+
 QHttpNetworkConnection* QHttpNetworkReply::connection()
 {
     return d_func()->connection;
@@ -257,7 +286,10 @@ QHttpNetworkReplyPrivate::QHttpNetworkReplyPrivate(const QUrl &newUrl)
       autoDecompress(false), responseData(), requestIsPrepared(false)
       ,pipeliningUsed(false), downstreamLimited(false)
       ,userProvidedDownloadBuffer(0)
+      ,dnsTime(-1), connectTime(-1), sslTime(-1), sslResumed(false)
+      ,sendStart(-1), sendEnd(-1), waitEnd(-1), receiveEnd(-1)
 {
+    timer.start();
 }
 
 QHttpNetworkReplyPrivate::~QHttpNetworkReplyPrivate()
@@ -75,6 +75,7 @@ static const unsigned char gz_magic[2] = {0x1f, 0x8b}; // gzip magic header
 #include <QtNetwork/qnetworkrequest.h>
 #include <QtNetwork/qnetworkreply.h>
 #include <qbuffer.h>
+#include <qelapsedtimer.h>
 
 #include <private/qobject_p.h>
 #include <private/qhttpnetworkheader_p.h>
@@ -138,6 +139,8 @@ public:
 
     bool isPipeliningUsed() const;
 
+    QVariantMap timings() const;
+
     QHttpNetworkConnection* connection();
 
 #ifndef QT_NO_OPENSSL
@@ -253,6 +256,19 @@ public:
     bool downstreamLimited;
 
     char* userProvidedDownloadBuffer;
+
+    // Phase timings, see QNetworkRequest::HttpTimingsAttribute.
+    // All in microseconds since the reply was created, -1 if not (yet) happened.
+    QElapsedTimer timer;
+    qint64 dnsTime;
+    qint64 connectTime;
+    qint64 sslTime;
+    bool sslResumed;
+    qint64 sendStart;
+    qint64 sendEnd;
+    qint64 waitEnd;
+    qint64 receiveEnd;
+    qint64 elapsed() const { return timer.nsecsElapsed() / 1000; }
 };
 
 
@@ -151,11 +151,11 @@ class QNetworkAccessCachedHttpConnection: public QHttpNetworkConnection,
     // Q_OBJECT
 public:
 #ifdef QT_NO_BEARERMANAGEMENT
-    QNetworkAccessCachedHttpConnection(const QString &hostName, quint16 port, bool encrypt)
-        : QHttpNetworkConnection(hostName, port, encrypt)
+    QNetworkAccessCachedHttpConnection(quint16 channelCount, const QString &hostName, quint16 port, bool encrypt)
+        : QHttpNetworkConnection(channelCount, hostName, port, encrypt)
 #else
-    QNetworkAccessCachedHttpConnection(const QString &hostName, quint16 port, bool encrypt, QSharedPointer<QNetworkSession> networkSession)
-        : QHttpNetworkConnection(hostName, port, encrypt, /*parent=*/0, networkSession)
+    QNetworkAccessCachedHttpConnection(quint16 channelCount, const QString &hostName, quint16 port, bool encrypt, QSharedPointer<QNetworkSession> networkSession)
+        : QHttpNetworkConnection(channelCount, hostName, port, encrypt, /*parent=*/0, networkSession)
 #endif
     {
         setExpires(true);
@@ -193,6 +193,8 @@ QHttpThreadDelegate::~QHttpThreadDelegate()
 QHttpThreadDelegate::QHttpThreadDelegate(QObject *parent) :
     QObject(parent)
     , ssl(false)
+    , channelCount(0)
+    , pipelineLength(0)
     , downloadBufferMaximumSize(0)
     , pendingDownloadData(0)
     , pendingDownloadProgress(0)
@@ -259,6 +261,13 @@ void QHttpThreadDelegate::startRequest()
 #endif
         cacheKey = makeCacheKey(urlCopy, 0);
 
+    // The number of channels and the pipeline length are fixed when the connection
+    // is created, so requests asking for non-default values get a connection of their own.
+    const int channels = channelCount > 0 ? channelCount : QHttpNetworkConnectionPrivate::defaultChannelCount;
+    if (channels != QHttpNetworkConnectionPrivate::defaultChannelCount)
+        cacheKey += "#channels=" + QByteArray::number(channels);
+    if (pipelineLength > 0 && pipelineLength != QHttpNetworkConnectionPrivate::defaultPipelineLength)
+        cacheKey += "#pipeline=" + QByteArray::number(pipelineLength);
 
     // the http object is actually a QHttpNetworkConnection
     httpConnection = static_cast<QNetworkAccessCachedHttpConnection *>(connections.localData()->requestEntryNow(cacheKey));
@@ -266,9 +275,9 @@ void QHttpThreadDelegate::startRequest()
         // no entry in cache; create an object
         // the http object is actually a QHttpNetworkConnection
 #ifdef QT_NO_BEARERMANAGEMENT
-        httpConnection = new QNetworkAccessCachedHttpConnection(urlCopy.host(), urlCopy.port(), ssl);
+        httpConnection = new QNetworkAccessCachedHttpConnection(channels, urlCopy.host(), urlCopy.port(), ssl);
 #else
-        httpConnection = new QNetworkAccessCachedHttpConnection(urlCopy.host(), urlCopy.port(), ssl, networkSession);
+        httpConnection = new QNetworkAccessCachedHttpConnection(channels, urlCopy.host(), urlCopy.port(), ssl, networkSession);
 #endif
 #ifndef QT_NO_OPENSSL
         // Set the QSslConfiguration from this QNetworkRequest.
@@ -281,12 +290,13 @@ void QHttpThreadDelegate::startRequest()
         httpConnection->setTransparentProxy(transparentProxy);
         httpConnection->setCacheProxy(cacheProxy);
 #endif
+        if (pipelineLength > 0)
+            httpConnection->setPipelineLength(pipelineLength);
 
         // cache the QHttpNetworkConnection corresponding to this cache key
         connections.localData()->addEntry(cacheKey, httpConnection);
     }
 
-
     // Send the request to the connection
     httpReply = httpConnection->sendRequest(httpRequest);
     httpReply->setParent(this);
@@ -390,6 +400,7 @@ void QHttpThreadDelegate::finishedSlot()
             emit error(statusCodeFromHttp(httpReply->statusCode(), httpRequest.url()), msg);
         }
 
+    emit downloadTimings(httpReply->timings());
     emit downloadFinished();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
@@ -411,6 +422,7 @@ void QHttpThreadDelegate::synchronousFinishedSlot()
     }
 
     synchronousDownloadData = httpReply->readAll();
+    incomingTimings = httpReply->timings();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
     QMetaObject::invokeMethod(synchronousRequestLoop, "quit", Qt::QueuedConnection);
@@ -432,6 +444,7 @@ void QHttpThreadDelegate::finishedWithErrorSlot(QNetworkReply::NetworkError erro
         emit sslConfigurationChanged(httpReply->sslConfiguration());
 #endif
     emit error(errorCode,detail);
+    emit downloadTimings(httpReply->timings());
     emit downloadFinished();
 
 
@@ -448,6 +461,8 @@ void QHttpThreadDelegate::synchronousFinishedWithErrorSlot(QNetworkReply::Networ
 #endif
     incomingErrorCode = errorCode;
     incomingErrorDetail = detail;
+    if (httpReply)
+        incomingTimings = httpReply->timings();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
     QMetaObject::invokeMethod(synchronousRequestLoop, "quit", Qt::QueuedConnection);
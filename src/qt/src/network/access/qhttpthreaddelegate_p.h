@@ -92,6 +92,9 @@ public:
     QSslConfiguration incomingSslConfiguration;
 #endif
     QHttpNetworkRequest httpRequest;
+    // 0 means the QHttpNetworkConnection defaults
+    int channelCount;
+    int pipelineLength;
     qint64 downloadBufferMaximumSize;
     // From backend, modified by us for signal compression
     QSharedPointer<QAtomicInt> pendingDownloadData;
@@ -110,6 +113,7 @@ public:
     QString incomingReasonPhrase;
     bool isPipeliningUsed;
     qint64 incomingContentLength;
+    QVariantMap incomingTimings;
     QNetworkReply::NetworkError incomingErrorCode;
     QString incomingErrorDetail;
 #ifndef QT_NO_BEARERMANAGEMENT
@@ -140,6 +144,7 @@ signals:
     void downloadProgress(qint64, qint64);
     void downloadData(QByteArray);
     void error(QNetworkReply::NetworkError, const QString);
+    void downloadTimings(QVariantMap);
     void downloadFinished();
 public slots:
     // This are called via QueuedConnection from user thread
@@ -53,6 +53,13 @@ enum ExpiryTimeEnum {
     ExpiryTime = 120
 };
 
+static int expiryTime = ExpiryTime;
+
+void qt_qnetworkaccesscache_set_expiry_time(int seconds)
+{
+    expiryTime = seconds > 0 ? seconds : int(ExpiryTime);
+}
+
 namespace {
     struct Receiver
     {
@@ -159,7 +166,7 @@ void QNetworkAccessCache::linkEntry(const QByteArray &key)
         oldest = node;
     }
 
-    node->timestamp = QDateTime::currentDateTime().addSecs(ExpiryTime);
+    node->timestamp = QDateTime::currentDateTime().addSecs(expiryTime);
     newest = node;
 }
 
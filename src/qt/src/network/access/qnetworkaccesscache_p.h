@@ -123,6 +123,9 @@ private:
     bool emitEntryReady(Node *node, QObject *target, const char *member);
 };
 
+// Seconds an unused entry is kept, 120 by default
+void Q_NETWORK_EXPORT qt_qnetworkaccesscache_set_expiry_time(int seconds);
+
 QT_END_NAMESPACE
 
 Q_DECLARE_METATYPE(QNetworkAccessCache::CacheableObject*)
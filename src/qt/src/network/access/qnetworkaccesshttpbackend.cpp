@@ -369,9 +369,14 @@ void QNetworkAccessHttpBackend::postRequest()
     } else if (!manager->httpThread) {
         // We use the manager-global thread.
         // At some point we could switch to having multiple threads if it makes sense.
-        manager->httpThread = new QThread();
-        QObject::connect(manager->httpThread, SIGNAL(finished()), manager->httpThread, SLOT(deleteLater()));
-        manager->httpThread->start();
+        if (QNetworkAccessManagerPrivate::isHttpThreadSharingEnabled()) {
+            manager->httpThread = QNetworkAccessManagerPrivate::acquireSharedHttpThread();
+            manager->httpThreadShared = true;
+        } else {
+            manager->httpThread = new QThread();
+            QObject::connect(manager->httpThread, SIGNAL(finished()), manager->httpThread, SLOT(deleteLater()));
+            manager->httpThread->start();
+        }
 #ifndef QT_NO_NETWORKPROXY
         qRegisterMetaType<QNetworkProxy>("QNetworkProxy");
 #endif
@@ -538,6 +543,8 @@ void QNetworkAccessHttpBackend::postRequest()
     delegate->transparentProxy = transparentProxy;
 #endif
     delegate->ssl = ssl;
+    delegate->channelCount = request().attribute(QNetworkRequest::HttpConnectionCountAttribute).toInt();
+    delegate->pipelineLength = request().attribute(QNetworkRequest::HttpPipelineLengthAttribute).toInt();
 #ifndef QT_NO_OPENSSL
     if (ssl)
         delegate->incomingSslConfiguration = request().sslConfiguration();
@@ -563,6 +570,9 @@ void QNetworkAccessHttpBackend::postRequest()
         connect(delegate, SIGNAL(downloadData(QByteArray)),
                 this, SLOT(replyDownloadData(QByteArray)),
                 Qt::QueuedConnection);
+        connect(delegate, SIGNAL(downloadTimings(QVariantMap)),
+                this, SLOT(replyDownloadTimings(QVariantMap)),
+                Qt::QueuedConnection);
         connect(delegate, SIGNAL(downloadFinished()),
                 this, SLOT(replyFinished()),
                 Qt::QueuedConnection);
@@ -666,6 +676,8 @@ void QNetworkAccessHttpBackend::postRequest()
             replyDownloadData(delegate->synchronousDownloadData);
         }
 
+        replyDownloadTimings(delegate->incomingTimings);
+
         // End the thread. It will delete itself from the finished() signal
         thread->quit();
         thread->wait(5000);
@@ -739,6 +751,14 @@ void QNetworkAccessHttpBackend::replyFinished()
     finished();
 }
 
+void QNetworkAccessHttpBackend::replyDownloadTimings(const QVariantMap &timings)
+{
+    if (loadingFromCache)
+        return;
+
+    setAttribute(QNetworkRequest::HttpTimingsAttribute, timings);
+}
+
 void QNetworkAccessHttpBackend::checkForRedirect(const int statusCode)
 {
     switch (statusCode) {
@@ -113,6 +113,7 @@ private slots:
     // From HTTP thread:
     void replyDownloadData(QByteArray);
     void replyFinished();
+    void replyDownloadTimings(const QVariantMap &timings);
     void replyDownloadMetaData(QList<QPair<QByteArray,QByteArray> >,int,QString,bool,QSharedPointer<char>,qint64);
     void replyDownloadProgressSlot(qint64,qint64);
     void httpAuthenticationRequired(const QHttpNetworkRequest &request, QAuthenticator *auth);
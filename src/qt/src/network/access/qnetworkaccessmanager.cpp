@@ -68,6 +68,7 @@
 #include "qhttpmultipart_p.h"
 
 #include "qthread.h"
+#include "qmutex.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -83,6 +84,24 @@ Q_GLOBAL_STATIC(QNetworkAccessFtpBackendFactory, ftpBackend)
 Q_GLOBAL_STATIC(QNetworkAccessDebugPipeBackendFactory, debugpipeBackend)
 #endif
 
+struct QSharedHttpThread
+{
+    QSharedHttpThread() : enabled(false), thread(0), refCount(0) { }
+
+    QMutex mutex;
+    bool enabled;
+    QThread *thread;
+    int refCount;
+};
+Q_GLOBAL_STATIC(QSharedHttpThread, sharedHttpThread)
+
+void qt_qnetworkaccessmanager_share_http_thread(bool share)
+{
+    QSharedHttpThread *shared = sharedHttpThread();
+    QMutexLocker locker(&shared->mutex);
+    shared->enabled = share;
+}
+
 static void ensureInitialized()
 {
 #ifndef QT_NO_HTTP
@@ -1149,22 +1168,66 @@ void QNetworkAccessManagerPrivate::clearCache(QNetworkAccessManager *manager)
     manager->d_func()->objectCache.clear();
     manager->d_func()->authenticationManager->clearCache();
 
-    if (manager->d_func()->httpThread) {
-        // The thread will deleteLater() itself from its finished() signal
-        manager->d_func()->httpThread->quit();
-        manager->d_func()->httpThread->wait(5000);
-        manager->d_func()->httpThread = 0;
-    }
+    // A shared thread keeps its connections: the other managers still use them
+    manager->d_func()->releaseHttpThread();
 }
 
 QNetworkAccessManagerPrivate::~QNetworkAccessManagerPrivate()
 {
-    if (httpThread) {
+    releaseHttpThread();
+}
+
+void QNetworkAccessManagerPrivate::releaseHttpThread()
+{
+    if (!httpThread)
+        return;
+
+    if (httpThreadShared) {
+        releaseSharedHttpThread();
+    } else {
         // The thread will deleteLater() itself from its finished() signal
         httpThread->quit();
         httpThread->wait(5000);
-        httpThread = 0;
     }
+    httpThread = 0;
+    httpThreadShared = false;
+}
+
+bool QNetworkAccessManagerPrivate::isHttpThreadSharingEnabled()
+{
+    QSharedHttpThread *shared = sharedHttpThread();
+    if (!shared)
+        return false;
+    QMutexLocker locker(&shared->mutex);
+    return shared->enabled;
+}
+
+QThread *QNetworkAccessManagerPrivate::acquireSharedHttpThread()
+{
+    QSharedHttpThread *shared = sharedHttpThread();
+    QMutexLocker locker(&shared->mutex);
+    if (!shared->thread) {
+        shared->thread = new QThread();
+        QObject::connect(shared->thread, SIGNAL(finished()), shared->thread, SLOT(deleteLater()));
+        shared->thread->start();
+    }
+    ++shared->refCount;
+    return shared->thread;
+}
+
+void QNetworkAccessManagerPrivate::releaseSharedHttpThread()
+{
+    QSharedHttpThread *shared = sharedHttpThread();
+    if (!shared)
+        return;
+    QMutexLocker locker(&shared->mutex);
+    if (--shared->refCount > 0)
+        return;
+
+    // Last user gone: the thread will deleteLater() itself from its finished() signal
+    shared->thread->quit();
+    shared->thread->wait(5000);
+    shared->thread = 0;
 }
 
 #ifndef QT_NO_BEARERMANAGEMENT
@@ -73,7 +73,7 @@ class QNetworkAccessManagerPrivate: public QObjectPrivate
 public:
     QNetworkAccessManagerPrivate()
         : networkCache(0), cookieJar(0),
-          httpThread(0),
+          httpThread(0), httpThreadShared(false),
 #ifndef QT_NO_NETWORKPROXY
           proxyFactory(0),
 #endif
@@ -128,7 +128,14 @@ public:
     QNetworkCookieJar *cookieJar;
 
     QThread *httpThread;
+    bool httpThreadShared;
 
+    // The HTTP connections are cached per thread: managers sharing the
+    // thread also share the keep-alive connections and their TLS sessions.
+    static bool isHttpThreadSharingEnabled();
+    static QThread *acquireSharedHttpThread();
+    static void releaseSharedHttpThread();
+    void releaseHttpThread();
 
 #ifndef QT_NO_NETWORKPROXY
     QNetworkProxy proxy;
@@ -159,6 +166,9 @@ public:
     Q_DECLARE_PUBLIC(QNetworkAccessManager)
 };
 
+// Managers started after this call use one HTTP thread for all of them
+void Q_NETWORK_EXPORT qt_qnetworkaccessmanager_share_http_thread(bool share);
+
 QT_END_NAMESPACE
 
 #endif
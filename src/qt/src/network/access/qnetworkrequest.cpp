@@ -228,6 +228,30 @@ QT_BEGIN_NAMESPACE
 
     \omitvalue SynchronousRequestAttribute
 
+    \value HttpTimingsAttribute
+        Replies only, type: QVariant::Map (no default)
+        Duration of each phase of an HTTP request, in microseconds:
+        "blocked" (queued, waiting for a connection), "dns", "connect",
+        "ssl", "send", "wait" (until the first byte of the response) and
+        "receive". Phases that did not happen, like the connection setup
+        on a reused connection, are -1. After an SSL handshake,
+        "sslResumed" tells whether it resumed the session of a previous
+        connection. Set when the reply finishes; not set for replies
+        served from the cache.
+
+    \value HttpConnectionCountAttribute
+        Requests only, type: QVariant::Int (default: 6)
+        Maximum number of parallel connections to the host of the
+        request. The count is fixed when the connections to a host are
+        set up: requests asking for different counts do not share
+        connections.
+
+    \value HttpPipelineLengthAttribute
+        Requests only, type: QVariant::Int (default: 3)
+        Maximum number of requests pipelined on one connection when
+        HttpPipeliningAllowedAttribute is set. Like the connection
+        count, it is fixed when the connections to a host are set up.
+
     \value User
         Special type. Additional information can be passed in
         QVariants with types ranging from User to UserMax. The default
@@ -86,6 +86,9 @@ public:
         MaximumDownloadBufferSizeAttribute, // internal
         DownloadBufferAttribute, // internal
         SynchronousRequestAttribute, // internal
+        HttpTimingsAttribute,
+        HttpConnectionCountAttribute,
+        HttpPipelineLengthAttribute,
 
         User = 1000,
         UserMax = 32767
@@ -43,6 +43,8 @@
 #include "qhostinfo_p.h"
 
 #include "QtCore/qscopedpointer.h"
+#include "QtCore/qdatastream.h"
+#include "QtCore/qdatetime.h"
 #include <qabstracteventdispatcher.h>
 #include <qcoreapplication.h>
 #include <qmetaobject.h>
@@ -546,6 +548,11 @@ QHostInfoLookupManager::QHostInfoLookupManager() : mutex(QMutex::Recursive), was
     threadPool.setMaxThreadCount(5); // do 5 DNS lookups in parallel
 }
 
+void QHostInfoLookupManager::setMaxThreadCount(int threads)
+{
+    threadPool.setMaxThreadCount(threads);
+}
+
 QHostInfoLookupManager::~QHostInfoLookupManager()
 {
     wasDeleted = true;
@@ -741,6 +748,46 @@ void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e)
     }
 }
 
+void qt_qhostinfo_set_cache_size(int entries)
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager && entries > 0) {
+        manager->cache.setMaxEntries(entries);
+    }
+}
+
+void qt_qhostinfo_set_cache_max_age(int seconds)
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager && seconds >= 0) {
+        manager->cache.setMaxAge(seconds);
+    }
+}
+
+void qt_qhostinfo_set_max_lookup_threads(int threads)
+{
+#ifndef Q_OS_SYMBIAN
+    QHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager && threads > 0) {
+        manager->setMaxThreadCount(threads);
+    }
+#else
+    Q_UNUSED(threads);
+#endif
+}
+
+QByteArray qt_qhostinfo_cache_snapshot()
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    return manager ? manager->cache.snapshot() : QByteArray();
+}
+
+int qt_qhostinfo_restore_cache_snapshot(const QByteArray &snapshot)
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    return manager ? manager->cache.restore(snapshot) : 0;
+}
+
 // cache for 60 seconds
 // cache 64 items
 QHostInfoCache::QHostInfoCache() : max_age(60), enabled(true), cache(64)
@@ -770,7 +817,7 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
     *valid = false;
     if (cache.contains(name)) {
         QHostInfoCacheElement *element = cache.object(name);
-        if (element->age.elapsed() < max_age*1000)
+        if (element->initialAge + element->age.elapsed() < max_age*1000)
             *valid = true;
         return element->info;
 
@@ -803,6 +850,79 @@ void QHostInfoCache::clear()
     cache.clear();
 }
 
+void QHostInfoCache::setMaxAge(int seconds)
+{
+    QMutexLocker locker(&this->mutex);
+    max_age = seconds;
+}
+
+void QHostInfoCache::setMaxEntries(int entries)
+{
+    QMutexLocker locker(&this->mutex);
+    cache.setMaxCost(entries);
+}
+
+enum { HostInfoSnapshotVersion = 1 };
+
+QByteArray QHostInfoCache::snapshot()
+{
+    QMutexLocker locker(&this->mutex);
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << qint32(HostInfoSnapshotVersion) << QDateTime::currentMSecsSinceEpoch();
+
+    QList<QString> names;
+    foreach (const QString &name, cache.keys()) {
+        const QHostInfoCacheElement *element = cache.object(name);
+        if (element->initialAge + element->age.elapsed() < max_age*1000)
+            names << name;
+    }
+    stream << qint32(names.count());
+    foreach (const QString &name, names) {
+        const QHostInfoCacheElement *element = cache.object(name);
+        stream << name << (element->initialAge + element->age.elapsed()) << element->info.addresses();
+    }
+    return data;
+}
+
+int QHostInfoCache::restore(const QByteArray &snapshot)
+{
+    QDataStream stream(snapshot);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    qint32 version, count;
+    qint64 takenAt;
+    stream >> version >> takenAt >> count;
+    if (stream.status() != QDataStream::Ok || version != HostInfoSnapshotVersion)
+        return 0;
+    const qint64 sinceSnapshot = qMax(qint64(0), QDateTime::currentMSecsSinceEpoch() - takenAt);
+
+    QMutexLocker locker(&this->mutex);
+    int restored = 0;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString name;
+        qint64 age;
+        QList<QHostAddress> addresses;
+        stream >> name >> age >> addresses;
+        if (stream.status() != QDataStream::Ok)
+            break;
+        age += sinceSnapshot;
+        if (age >= max_age*1000 || addresses.isEmpty() || cache.contains(name))
+            continue;
+
+        QHostInfoCacheElement *element = new QHostInfoCacheElement();
+        element->info.setHostName(name);
+        element->info.setAddresses(addresses);
+        element->initialAge = age;
+        element->age.start();
+        cache.insert(name, element); // cache will take ownership
+        ++restored;
+    }
+    return restored;
+}
+
 QAbstractHostInfoLookupManager* QAbstractHostInfoLookupManager::globalInstance()
 {
     return theHostInfoLookupManager();
@@ -138,23 +138,40 @@ QHostInfo Q_NETWORK_EXPORT qt_qhostinfo_lookup(const QString &name, QObject *rec
 void Q_AUTOTEST_EXPORT qt_qhostinfo_clear_cache();
 void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e);
 
+// Tuning of the lookup cache and thread pool, and snapshots of the cache
+// (see QHostInfoCache::snapshot()) to start a new process with a warm cache.
+void Q_NETWORK_EXPORT qt_qhostinfo_set_cache_size(int entries);
+void Q_NETWORK_EXPORT qt_qhostinfo_set_cache_max_age(int seconds);
+void Q_NETWORK_EXPORT qt_qhostinfo_set_max_lookup_threads(int threads);
+QByteArray Q_NETWORK_EXPORT qt_qhostinfo_cache_snapshot();
+int Q_NETWORK_EXPORT qt_qhostinfo_restore_cache_snapshot(const QByteArray &snapshot);
+
 class QHostInfoCache
 {
 public:
     QHostInfoCache();
-    const int max_age; // seconds
+    int max_age; // seconds
 
     QHostInfo get(const QString &name, bool *valid);
     void put(const QString &name, const QHostInfo &info);
     void clear();
 
+    void setMaxAge(int seconds);
+    void setMaxEntries(int entries);
+
+    // Valid entries with their age; restore() skips the ones too old by now
+    QByteArray snapshot();
+    int restore(const QByteArray &snapshot);
+
     bool isEnabled();
     void setEnabled(bool e);
 private:
     bool enabled;
     struct QHostInfoCacheElement {
+        QHostInfoCacheElement() : initialAge(0) { }
         QHostInfo info;
         QElapsedTimer age;
+        qint64 initialAge; // msecs, when restored from a snapshot
     };
     QCache<QString,QHostInfoCacheElement> cache;
     QMutex mutex;
@@ -201,6 +218,8 @@ public:
     void clear();
     void work();
 
+    void setMaxThreadCount(int threads);
+
     // called from QHostInfo
     void scheduleLookup(QHostInfoRunnable *r);
     void abortLookup(int id);
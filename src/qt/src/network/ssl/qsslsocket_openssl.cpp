@@ -47,6 +47,7 @@
 #include "qsslcertificate_p.h"
 #include "qsslcipher_p.h"
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
@@ -54,7 +55,9 @@
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmutex.h>
+#include <QtCore/qstringlist.h>
 #include <QtCore/qthread.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qvarlengtharray.h>
@@ -169,6 +172,70 @@ static unsigned long id_function()
 }
 } // extern "C"
 
+// Sessions of client connections, for abbreviated handshakes with the same peer.
+// When full, the least recently used session is dropped.
+class QSslSessionCache
+{
+public:
+    enum { MaxSessions = 256 };
+
+    QSslSessionCache(int maxSessions = MaxSessions) : enabled(true), maxSessions(qMax(1, maxSessions)) { }
+    ~QSslSessionCache()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&mutex);
+        foreach (SSL_SESSION *session, sessions)
+            q_SSL_SESSION_free(session);
+        sessions.clear();
+        order.clear();
+    }
+
+    // The session of "key", which becomes the most recently used (with "mutex" locked)
+    SSL_SESSION *find(const QString &key)
+    {
+        SSL_SESSION *session = sessions.value(key);
+        if (session) {
+            order.removeOne(key);
+            order.append(key);
+        }
+        return session;
+    }
+
+    // Takes ownership of "session" (with "mutex" locked)
+    void insert(const QString &key, SSL_SESSION *session)
+    {
+        SSL_SESSION *previous = sessions.take(key);
+        if (previous) {
+            q_SSL_SESSION_free(previous);
+            order.removeOne(key);
+        }
+        while (order.size() >= maxSessions)
+            q_SSL_SESSION_free(sessions.take(order.takeFirst()));
+        sessions.insert(key, session);
+        order.append(key);
+    }
+
+    QMutex mutex;
+    bool enabled;
+    int maxSessions;
+    QHash<QString, SSL_SESSION *> sessions;
+    QStringList order; // Least recently used first
+};
+Q_GLOBAL_STATIC(QSslSessionCache, sslSessionCache)
+
+void qt_qsslsocket_enable_session_cache(bool enable)
+{
+    QSslSessionCache *cache = sslSessionCache();
+    if (!enable)
+        cache->clear();
+    QMutexLocker locker(&cache->mutex);
+    cache->enabled = enable;
+}
+
 QSslSocketBackendPrivate::QSslSocketBackendPrivate()
     : ssl(0),
       ctx(0),
@@ -462,6 +529,9 @@ init_context:
     q_SSL_clear(ssl);
     errorList.clear();
 
+    if (client)
+        resumeSession();
+
     // Initialize memory BIOs for encryption and decryption.
     readBio = q_BIO_new(q_BIO_s_mem());
     writeBio = q_BIO_new(q_BIO_s_mem());
@@ -1400,6 +1470,12 @@ bool QSslSocketBackendPrivate::startHandshake()
     if (readBufferMaxSize)
         plainSocket->setReadBufferSize(32768);
 
+    if (mode == QSslSocket::SslClientMode) {
+        // Reported in the timings of the HTTP replies (see QHttpNetworkConnectionChannel)
+        q->setProperty("_q_sslSessionResumed", q_SSL_ctrl(ssl, SSL_CTRL_GET_SESSION_REUSED, 0, 0) == 1);
+        storeSession();
+    }
+
     connectionEncrypted = true;
     emit q->encrypted();
     if (autoStartHandshake && pendingClose) {
@@ -1409,6 +1485,52 @@ bool QSslSocketBackendPrivate::startHandshake()
     return true;
 }
 
+void QSslSocketBackendPrivate::resumeSession()
+{
+    Q_Q(QSslSocket);
+
+    sessionCacheKey.clear();
+    // A session does not remember which client certificate it was made with
+    if (!configuration.privateKey.isNull() || !configuration.localCertificate.isNull())
+        return;
+
+    QSslSessionCache *cache = sslSessionCache();
+    QMutexLocker locker(&cache->mutex);
+    if (!cache->enabled)
+        return;
+
+    // A session is only valid for the CA certificates its peer was verified against
+    QCryptographicHash caCertificates(QCryptographicHash::Sha1);
+    foreach (const QSslCertificate &certificate, configuration.caCertificates)
+        caCertificates.addData(certificate.toDer());
+
+    const QString peerName = verificationPeerName.isEmpty() ? q->peerName() : verificationPeerName;
+    sessionCacheKey = peerName + QLatin1Char(':') + QString::number(q->peerPort())
+                      + QLatin1Char(':') + QString::number(int(configuration.protocol))
+                      + QLatin1Char(':') + QString::number(int(configuration.peerVerifyMode))
+                      + QLatin1Char(':') + QLatin1String(caCertificates.result().toHex());
+
+    SSL_SESSION *cached = cache->find(sessionCacheKey);
+    if (cached)
+        q_SSL_set_session(ssl, cached); // takes its own reference
+}
+
+void QSslSocketBackendPrivate::storeSession()
+{
+    // Only sessions verified without any error, even ignored ones, are
+    // reused: no verification is done when resuming.
+    if (sessionCacheKey.isEmpty() || !sslErrors.isEmpty())
+        return;
+
+    SSL_SESSION *current = q_SSL_get1_session(ssl);
+    if (!current)
+        return;
+
+    QSslSessionCache *cache = sslSessionCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->insert(sessionCacheKey, current);
+}
+
 void QSslSocketBackendPrivate::disconnectFromHost()
 {
     if (ssl) {
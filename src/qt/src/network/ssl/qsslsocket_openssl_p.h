@@ -106,6 +106,7 @@ public:
     BIO *readBio;
     BIO *writeBio;
     SSL_SESSION *session;
+    QString sessionCacheKey;
     X509_STORE *certificateStore;
     X509_STORE_CTX *certificateStoreCtx;
     QList<QPair<int, int> > errorList;
@@ -115,6 +116,8 @@ public:
     void startServerEncryption();
     void transmit();
     bool startHandshake();
+    void resumeSession();
+    void storeSession();
     void disconnectFromHost();
     void disconnected();
     QSslCipher sessionCipher() const;
@@ -180,6 +183,9 @@ private:
 #endif
 
 
+// Client sessions are kept per peer and resumed by the next connection (on by default)
+void Q_NETWORK_EXPORT qt_qsslsocket_enable_session_cache(bool enable);
+
 QT_END_NAMESPACE
 
 #endif
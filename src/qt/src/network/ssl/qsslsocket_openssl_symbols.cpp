@@ -189,6 +189,9 @@ DEFINEFUNC2(int, SSL_CTX_use_PrivateKey, SSL_CTX *a, a, EVP_PKEY *b, b, return -
 DEFINEFUNC2(int, SSL_CTX_use_RSAPrivateKey, SSL_CTX *a, a, RSA *b, b, return -1, return)
 DEFINEFUNC3(int, SSL_CTX_use_PrivateKey_file, SSL_CTX *a, a, const char *b, b, int c, c, return -1, return)
 DEFINEFUNC(void, SSL_free, SSL *a, a, return, DUMMYARG)
+DEFINEFUNC(SSL_SESSION *, SSL_get1_session, SSL *a, a, return 0, return)
+DEFINEFUNC2(int, SSL_set_session, SSL *a, a, SSL_SESSION *b, b, return 0, return)
+DEFINEFUNC(void, SSL_SESSION_free, SSL_SESSION *a, a, return, DUMMYARG)
 #if OPENSSL_VERSION_NUMBER >= 0x00908000L
 // 0.9.8 broke SC and BC by changing this function's signature.
 DEFINEFUNC(STACK_OF(SSL_CIPHER) *, SSL_get_ciphers, const SSL *a, a, return 0, return)
@@ -788,6 +791,9 @@ bool q_resolveOpenSslSymbols()
     RESOLVEFUNC(SSL_clear)
     RESOLVEFUNC(SSL_connect)
     RESOLVEFUNC(SSL_free)
+    RESOLVEFUNC(SSL_get1_session)
+    RESOLVEFUNC(SSL_set_session)
+    RESOLVEFUNC(SSL_SESSION_free)
     RESOLVEFUNC(SSL_get_ciphers)
     RESOLVEFUNC(SSL_get_current_cipher)
     RESOLVEFUNC(SSL_get_error)
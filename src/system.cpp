@@ -29,6 +29,7 @@
 
 #include "system.h"
 
+#include <QCoreApplication>
 #include <QSslSocket>
 #include <QSysInfo>
 #include <QVariantMap>
@@ -145,6 +146,11 @@ bool System::isSSLSupported() const
     return QSslSocket::supportsSsl();
 }
 
+QString System::executablePath() const
+{
+    return QCoreApplication::applicationFilePath();
+}
+
 void System::initCompletions()
 {
     addCompletion("args");
@@ -152,4 +158,5 @@ void System::initCompletions()
     addCompletion("platform");
     addCompletion("os");
     addCompletion("isSSLSupported");
+    addCompletion("executablePath");
 }
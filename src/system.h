@@ -46,6 +46,7 @@ class System : public REPLCompletable
     Q_PROPERTY(QVariant env READ env)
     Q_PROPERTY(QVariant os READ os)
     Q_PROPERTY(bool isSSLSupported READ isSSLSupported)
+    Q_PROPERTY(QString executablePath READ executablePath)
 
 public:
     explicit System(QObject *parent = 0);
@@ -59,6 +60,9 @@ public:
 
     bool isSSLSupported() const;
 
+    // Absolute path of this PhantomJS executable
+    QString executablePath() const;
+
 private:
     QStringList m_args;
     QVariant m_env;
@@ -0,0 +1,178 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "urlblocklist.h"
+
+#include <QFile>
+#include <QTextStream>
+
+// Pattern matching a whole URL, where only '*' is a wildcard
+static QRegExp wildcardPattern(const QString &rule)
+{
+    QStringList parts = rule.split('*');
+    for (int i = 0; i < parts.size(); ++i)
+        parts[i] = QRegExp::escape(parts[i]);
+    return QRegExp(parts.join(".*"), Qt::CaseInsensitive, QRegExp::RegExp2);
+}
+
+UrlBlocklist::UrlBlocklist()
+{
+}
+
+bool UrlBlocklist::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+        return false;
+
+    QStringList rules;
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while (!in.atEnd())
+        rules << in.readLine();
+
+    setRules(rules);
+    return true;
+}
+
+void UrlBlocklist::setRules(const QStringList &rules)
+{
+    m_rules.clear();
+    m_hosts.clear();
+    m_prefixesByHost.clear();
+    m_prefixes.clear();
+    m_pathsByAuthority.clear();
+    m_patterns.clear();
+
+    foreach (const QString &line, rules) {
+        const QString rule = line.trimmed();
+        if (rule.isEmpty() || rule.startsWith('!') || rule.startsWith('#'))
+            continue;
+        m_rules << rule;
+        addRule(rule);
+    }
+}
+
+QStringList UrlBlocklist::rules() const
+{
+    return m_rules;
+}
+
+bool UrlBlocklist::isEmpty() const
+{
+    return m_rules.isEmpty();
+}
+
+void UrlBlocklist::addRule(const QString &rule)
+{
+    if (rule.contains('*')) {
+        // A trailing '*' is implied for a prefix anyway
+        QString prefix = rule;
+        while (prefix.endsWith('*'))
+            prefix.chop(1);
+        if (!prefix.contains('*') && prefix.contains('/')) {
+            addRule(prefix);
+        } else {
+            m_patterns << wildcardPattern(rule);
+        }
+        return;
+    }
+
+    if (!rule.contains('/') && !rule.contains(':')) {
+        QString host = rule.toLower();
+        if (host.startsWith("||"))
+            host.remove(0, 2);
+        if (host.startsWith('.'))
+            host.remove(0, 1);
+        if (!host.isEmpty())
+            m_hosts.insert(host);
+        return;
+    }
+
+    if (!rule.contains("://")) {
+        // "example.com/ads": bucketed by host (and port), compared with the path
+        const int slash = rule.indexOf('/');
+        const QString authority = rule.left(slash).toLower();
+        m_pathsByAuthority[authority] << (slash == -1 ? QString() : rule.mid(slash));
+        return;
+    }
+
+    const QUrl url(rule);
+    const QString host = url.host().toLower();
+    if (host.isEmpty())
+        m_prefixes << rule;
+    else
+        m_prefixesByHost[host] << rule;
+}
+
+bool UrlBlocklist::matchesHost(const QString &host) const
+{
+    if (m_hosts.isEmpty())
+        return false;
+
+    // "a.b.example.com", then "b.example.com", "example.com" and "com"
+    int dot = -1;
+    do {
+        if (m_hosts.contains(host.mid(dot + 1)))
+            return true;
+        dot = host.indexOf('.', dot + 1);
+    } while (dot != -1);
+    return false;
+}
+
+bool UrlBlocklist::matches(const QUrl &url) const
+{
+    if (m_rules.isEmpty())
+        return false;
+
+    const QString host = url.host().toLower();
+    if (matchesHost(host))
+        return true;
+
+    const QString address = url.toString();
+    foreach (const QString &prefix, m_prefixesByHost.value(host)) {
+        if (address.startsWith(prefix, Qt::CaseInsensitive))
+            return true;
+    }
+    foreach (const QString &prefix, m_prefixes) {
+        if (address.startsWith(prefix, Qt::CaseInsensitive))
+            return true;
+    }
+    if (!m_pathsByAuthority.isEmpty()) {
+        const QString authority = url.port() == -1 ? host : host + ':' + QString::number(url.port());
+        const QString path = url.toString(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+        foreach (const QString &prefix, m_pathsByAuthority.value(authority)) {
+            if (path.startsWith(prefix, Qt::CaseInsensitive))
+                return true;
+        }
+    }
+    foreach (const QRegExp &pattern, m_patterns) {
+        if (pattern.exactMatch(address))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,76 @@
+/*
+  This file is part of the PhantomJS project from Ofi Labs.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef URLBLOCKLIST_H
+#define URLBLOCKLIST_H
+
+#include <QHash>
+#include <QList>
+#include <QRegExp>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+/**
+ * Set of rules telling which URLs must never be requested. One rule per
+ * line, lines starting with '!' or '#' are comments:
+ * - "example.com", ".example.com" or "||example.com": the host and all its
+ *   subdomains;
+ * - "http://example.com/ads/": URLs starting with this prefix;
+ * - "example.com/ads" or "example.com:8080": URLs of this host (and port)
+ *   whose path starts with this one, whatever their scheme;
+ * - "*.woff", "*?utm_source=*": URLs matching this pattern, where only '*'
+ *   is a wildcard.
+ *
+ * Rules are compiled on load: hosts in a suffix set and prefixes bucketed
+ * by host, so most URLs are checked with a few hash lookups.
+ */
+class UrlBlocklist
+{
+public:
+    UrlBlocklist();
+
+    bool load(const QString &filePath);
+    void setRules(const QStringList &rules);
+    QStringList rules() const;
+
+    bool isEmpty() const;
+    bool matches(const QUrl &url) const;
+
+private:
+    void addRule(const QString &rule);
+    bool matchesHost(const QString &host) const;
+
+    QStringList m_rules;
+    QSet<QString> m_hosts;
+    QHash<QString, QStringList> m_prefixesByHost;
+    QStringList m_prefixes;
+    QHash<QString, QStringList> m_pathsByAuthority;
+    QList<QRegExp> m_patterns;
+};
+
+#endif // URLBLOCKLIST_H
@@ -29,15 +29,35 @@
 */
 
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 #include <QDateTime>
 #include <QDir>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QTemporaryFile>
 
+#include "compilecache.h"
 #include "consts.h"
 #include "terminal.h"
 #include "utils.h"
 
+// Decoded (and compiled) script files, valid as long as the file content is
+// unchanged: file times are too coarse to notice quick successive edits
+struct ScriptCacheEntry {
+    QByteArray hash;
+    QString encoding;
+    QString body;
+};
+static QHash<QString, ScriptCacheEntry> scriptCache;
+static int scriptCacheHits = 0;
+static int scriptCacheMisses = 0;
+
+static QElapsedTimer startupTimer;
+static qint64 startupLastMark = 0;
+static QVariantMap startupPhases;
+
 QTemporaryFile* Utils::m_tempHarness = 0;
 QTemporaryFile* Utils::m_tempWrapper = 0;
 bool Utils::printDebugMessages = false;
@@ -96,7 +116,20 @@ bool Utils::exceptionHandler(const char* dump_path, const char* minidump_id, voi
 
 QVariant Utils::coffee2js(const QString &script)
 {
-    return CSConverter::instance()->convert(script);
+    CompileCache *cache = CompileCache::instance();
+    if (cache->isEnabled()) {
+        // A hit must not instantiate the converter, that is the expensive part
+        const QString compiled = cache->find(CSConverter::compilerId(), script);
+        if (!compiled.isNull()) {
+            return QVariantList() << true << compiled;
+        }
+    }
+
+    QVariant result = CSConverter::instance()->convert(script);
+    if (cache->isEnabled() && result.toStringList().at(0) == "true") {
+        cache->insert(CSConverter::compilerId(), script, result.toStringList().at(1));
+    }
+    return result;
 }
 
 bool Utils::injectJsInFrame(const QString &jsFilePath, const QString &libraryPath, QWebFrame *targetFrame, const bool startingScript)
@@ -162,11 +195,32 @@ QString Utils::findScript(const QString& jsFilePath, const QString &libraryPath)
     return QString();
 }
 
+QVariantMap Utils::scriptCacheStatistics()
+{
+    QVariantMap statistics;
+    statistics["entries"] = scriptCache.size();
+    statistics["hits"] = scriptCacheHits;
+    statistics["misses"] = scriptCacheMisses;
+    return statistics;
+}
+
 QString Utils::jsFromScriptFile(const QString& scriptPath, const Encoding& enc)
 {
     QFile jsFile(scriptPath);
     if (jsFile.exists() && jsFile.open(QFile::ReadOnly)) {
-        QString scriptBody = enc.decode(jsFile.readAll());
+        const QByteArray source = jsFile.readAll();
+
+        // Reading the file is cheap, decoding and compiling it is not
+        const QString key = QFileInfo(scriptPath).absoluteFilePath();
+        const QByteArray hash = QCryptographicHash::hash(source, QCryptographicHash::Sha1);
+        QHash<QString, ScriptCacheEntry>::const_iterator cached = scriptCache.constFind(key);
+        if (cached != scriptCache.constEnd() && cached->hash == hash && cached->encoding == enc.getName()) {
+            ++scriptCacheHits;
+            return cached->body;
+        }
+        ++scriptCacheMisses;
+
+        QString scriptBody = enc.decode(source);
         // Remove CLI script heading
         if (scriptBody.startsWith("#!") && !jsFile.fileName().endsWith(COFFEE_SCRIPT_EXTENSION)) {
             scriptBody.prepend("//");
@@ -182,6 +236,12 @@ QString Utils::jsFromScriptFile(const QString& scriptPath, const Encoding& enc)
         }
         jsFile.close();
 
+        ScriptCacheEntry entry;
+        entry.hash = hash;
+        entry.encoding = enc.getName();
+        entry.body = scriptBody;
+        scriptCache.insert(key, entry);
+
         return scriptBody;
     } else {
         return QString();
@@ -204,6 +264,28 @@ Utils::cleanupFromDebug()
 }
 
 
+void Utils::markStartupPhase(const QString &phase)
+{
+    if (!startupTimer.isValid()) {
+        startupTimer.start();
+        return;
+    }
+    if (startupPhases.contains(phase)) {
+        return;
+    }
+
+    const qint64 now = startupTimer.nsecsElapsed();
+    startupPhases[phase] = (now - startupLastMark) / 1000000.0;
+    startupLastMark = now;
+}
+
+QVariantMap Utils::startupTimings()
+{
+    QVariantMap timings = startupPhases;
+    timings["total"] = startupTimer.isValid() ? startupTimer.nsecsElapsed() / 1000000.0 : 0.0;
+    return timings;
+}
+
 QString Utils::readResourceFileUtf8(const QString &resourceFilePath)
 {
     QFile f(resourceFilePath);
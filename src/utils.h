@@ -66,6 +66,17 @@ public:
     static bool loadJSForDebug(const QString &jsFilePath, const QString &libraryPath, QWebFrame *targetFrame, const bool autorun = false);
     static void cleanupFromDebug();
 
+    /**
+     * Records the end of startup phase @p phase. The first call (from main())
+     * starts the clock, later calls for the same phase are ignored.
+     */
+    static void markStartupPhase(const QString &phase);
+    /// Duration of each startup phase and the "total" so far (in ms)
+    static QVariantMap startupTimings();
+
+    /// "entries", "hits" and "misses" of the in-memory cache of injected scripts
+    static QVariantMap scriptCacheStatistics();
+
     static bool printDebugMessages;
 
 private:
@@ -46,6 +46,7 @@
 #include <QPrinter>
 #include <QWebElement>
 #include <QWebFrame>
+#include <QWebHistory>
 #include <QWebPage>
 #include <QWebInspector>
 #include <QMapIterator>
@@ -54,6 +55,8 @@
 #include <QImageWriter>
 
 #include <gifwriter.h>
+#include <stripencoder.h>
+#include <base64device.h>
 
 #include "phantom.h"
 #include "networkaccessmanager.h"
@@ -63,6 +66,10 @@
 #include "callback.h"
 #include "cookiejar.h"
 
+// Exported by QtWebKit (see "DumpRenderTreeSupportQt.cpp")
+QWEBKIT_EXPORT QVariant qt_drt_evaluateFunction(QWebFrame *frame, const QString &source, const QVariantList &arguments, const QString &location);
+QWEBKIT_EXPORT QVariant qt_drt_evaluateFunctionSerialized(QWebFrame *frame, const QString &source, const QVariantList &arguments, const QString &location);
+
 // Ensure we have at least head and body.
 #define BLANK_HTML                      "<html><head></head><body></body></html>"
 #define CALLBACKS_OBJECT_NAME           "_phantom"
@@ -272,7 +279,10 @@ private:
 WebPage::WebPage(QObject *parent, const QUrl &baseUrl)
     : REPLCompletable(parent)
     , m_callbacks(NULL)
+    , m_renderAtCurrentLayout(false)
+    , m_damageComplete(true)
     , m_navigationLocked(false)
+    , m_gifAnimation(NULL)
     , m_mousePos(QPoint(0, 0))
     , m_ownsPages(true)
 {
@@ -290,6 +300,8 @@ WebPage::WebPage(QObject *parent, const QUrl &baseUrl)
     connect(m_customWebPage, SIGNAL(loadStarted()), SIGNAL(loadStarted()), Qt::QueuedConnection);
     connect(m_customWebPage, SIGNAL(loadFinished(bool)), SLOT(finish(bool)), Qt::QueuedConnection);
     connect(m_customWebPage, SIGNAL(windowCloseRequested()), this, SLOT(close()));
+    connect(m_customWebPage, SIGNAL(repaintRequested(QRect)), this, SLOT(handleRepaintRequested(QRect)));
+    connect(m_customWebPage, SIGNAL(scrollRequested(int,int,QRect)), this, SLOT(handleScrollRequested()));
 
     // Start with transparent background.
     QPalette palette = m_customWebPage->palette();
@@ -328,12 +340,15 @@ WebPage::WebPage(QObject *parent, const QUrl &baseUrl)
             SIGNAL(resourceRequested(QVariant)));
     connect(m_networkAccessManager, SIGNAL(resourceReceived(QVariant)),
             SIGNAL(resourceReceived(QVariant)));
+    connect(m_networkAccessManager, SIGNAL(networkIdle(int,int)),
+            SIGNAL(networkIdle(int,int)));
 
     m_customWebPage->setViewportSize(QSize(400, 300));
 }
 
 WebPage::~WebPage()
 {
+    finishGif();
     emit closing(this);
 }
 
@@ -357,6 +372,11 @@ void WebPage::setContent(const QString &content)
     m_mainFrame->setHtml(content);
 }
 
+void WebPage::setContent(const QString &content, const QString &baseUrl)
+{
+    m_mainFrame->setHtml(content, QUrl(baseUrl));
+}
+
 void WebPage::setFrameContent(const QString &content)
 {
     m_currentFrame->setHtml(content);
@@ -435,6 +455,22 @@ void WebPage::applySettings(const QVariantMap &def)
 
     if (def.contains(PAGE_SETTINGS_PASSWORD))
         m_networkAccessManager->setPassword(def[PAGE_SETTINGS_PASSWORD].toString());
+
+    if (def.contains(PAGE_SETTINGS_MAX_CONNECTIONS))
+        m_networkAccessManager->setMaxConnectionsPerHost(def[PAGE_SETTINGS_MAX_CONNECTIONS].toInt());
+
+    if (def.contains(PAGE_SETTINGS_HOST_CONNECTIONS))
+        m_networkAccessManager->setHostConnections(def[PAGE_SETTINGS_HOST_CONNECTIONS].toMap());
+
+    if (def.contains(PAGE_SETTINGS_HTTP_PIPELINING))
+        m_networkAccessManager->setHttpPipelining(def[PAGE_SETTINGS_HTTP_PIPELINING].toBool(),
+                                                  def.value(PAGE_SETTINGS_HTTP_PIPELINE_LENGTH).toInt());
+
+    if (def.contains(PAGE_SETTINGS_RESOURCE_TIMEOUT))
+        m_networkAccessManager->setResourceTimeout(def[PAGE_SETTINGS_RESOURCE_TIMEOUT].toInt());
+
+    if (def.contains(PAGE_SETTINGS_HOST_RESOURCE_TIMEOUTS))
+        m_networkAccessManager->setHostResourceTimeouts(def[PAGE_SETTINGS_HOST_RESOURCE_TIMEOUTS].toMap());
 }
 
 QString WebPage::userAgent() const
@@ -490,6 +526,16 @@ QVariantMap WebPage::clipRect() const
     return result;
 }
 
+void WebPage::setRenderAtCurrentLayout(const bool enabled)
+{
+    m_renderAtCurrentLayout = enabled;
+}
+
+bool WebPage::renderAtCurrentLayout() const
+{
+    return m_renderAtCurrentLayout;
+}
+
 
 void WebPage::setScrollPosition(const QVariantMap &size)
 {
@@ -525,6 +571,17 @@ QVariant WebPage::evaluateJavaScript(const QString &code)
                 QString("phantomjs://webpage.evaluate()"));
 }
 
+QVariant WebPage::_evaluateFunction(const QString &function, const QVariantList &args)
+{
+    return qt_drt_evaluateFunction(m_currentFrame, function, args, QString("phantomjs://webpage.evaluate()"));
+}
+
+QVariant WebPage::_evaluateFunctionBulk(const QString &function, const QVariantList &args)
+{
+    // The result stays a structured clone until it reaches the phantom context
+    return qt_drt_evaluateFunctionSerialized(m_currentFrame, function, args, QString("phantomjs://webpage.evaluateBulk()"));
+}
+
 bool WebPage::javaScriptConfirm(const QString &msg)
 {
     if (m_callbacks->m_jsConfirmCallback) {
@@ -564,6 +621,46 @@ QVariantMap WebPage::customHeaders() const
     return m_networkAccessManager->customHeaders();
 }
 
+void WebPage::setResourceEventFields(const QStringList &fields)
+{
+    m_networkAccessManager->setResourceEventFields(fields);
+}
+
+QStringList WebPage::resourceEventFields() const
+{
+    return m_networkAccessManager->resourceEventFields();
+}
+
+void WebPage::setBlockedUrls(const QStringList &rules)
+{
+    m_networkAccessManager->setBlockedUrls(rules);
+}
+
+QStringList WebPage::blockedUrls() const
+{
+    return m_networkAccessManager->blockedUrls();
+}
+
+QVariantMap WebPage::networkActivity() const
+{
+    return m_networkAccessManager->activity();
+}
+
+void WebPage::waitForNetworkIdle(int quietMs, int maxInflight)
+{
+    m_networkAccessManager->watchNetworkIdle(quietMs, maxInflight);
+}
+
+bool WebPage::hasResourceRequestedHandlers() const
+{
+    return receivers(SIGNAL(resourceRequested(QVariant))) > 0;
+}
+
+bool WebPage::hasResourceReceivedHandlers() const
+{
+    return receivers(SIGNAL(resourceReceived(QVariant))) > 0;
+}
+
 bool WebPage::setCookies(const QVariantList &cookies)
 {
     // Delete all the cookies for this URL
@@ -658,6 +755,62 @@ void WebPage::openUrl(const QString &address, const QVariant &op, const QVariant
     }
 }
 
+void WebPage::reset()
+{
+    m_customWebPage->triggerAction(QWebPage::Stop);
+
+    foreach (QObject *page, pages()) {
+        static_cast<WebPage *>(page)->close();
+    }
+
+    // Handlers connected by the script
+    disconnect(this, SIGNAL(initialized()), 0, 0);
+    disconnect(this, SIGNAL(loadStarted()), 0, 0);
+    disconnect(this, SIGNAL(loadFinished(QString)), 0, 0);
+    disconnect(this, SIGNAL(javaScriptAlertSent(QString)), 0, 0);
+    disconnect(this, SIGNAL(javaScriptConsoleMessageSent(QString)), 0, 0);
+    disconnect(this, SIGNAL(javaScriptErrorSent(QString,QString)), 0, 0);
+    disconnect(this, SIGNAL(resourceRequested(QVariant)), 0, 0);
+    disconnect(this, SIGNAL(resourceReceived(QVariant)), 0, 0);
+    disconnect(this, SIGNAL(networkIdle(int,int)), 0, 0);
+    disconnect(this, SIGNAL(urlChanged(QUrl)), 0, 0);
+    disconnect(this, SIGNAL(navigationRequested(QUrl,QString,bool,bool)), 0, 0);
+    disconnect(this, SIGNAL(rawPageCreated(QObject*)), 0, 0);
+    disconnect(this, SIGNAL(closing(QObject*)), 0, 0);
+
+    // Might be reset from within one of the callbacks
+    if (m_callbacks) {
+        m_callbacks->deleteLater();
+        m_callbacks = NULL;
+    }
+
+    finishGif();
+    m_mainFrame->setHtml(BLANK_HTML);
+    m_customWebPage->history()->clear();
+    switchToMainFrame();
+
+    m_customWebPage->setViewportSize(QSize(400, 300));
+    m_customWebPage->m_uploadFile.clear();
+    m_mainFrame->setZoomFactor(1.0);
+    m_clipRect = QRect();
+    m_renderAtCurrentLayout = false;
+    m_damage = QRegion();
+    m_damageComplete = true;
+    m_scrollPosition = QPoint();
+    m_paperSize.clear();
+    m_navigationLocked = false;
+    m_mousePos = QPoint(0, 0);
+    m_ownsPages = true;
+    setLibraryPath(QFileInfo(Phantom::instance()->config()->scriptFile()).dir().absolutePath());
+
+    m_networkAccessManager->setUserName(QString());
+    m_networkAccessManager->setPassword(QString());
+    m_networkAccessManager->setCustomHeaders(QVariantMap());
+    m_networkAccessManager->setResourceEventFields(QStringList());
+    m_networkAccessManager->setBlockedUrls(QStringList());
+    m_networkAccessManager->watchNetworkIdle(-1, 0);
+}
+
 void WebPage::release()
 {
     close();
@@ -679,6 +832,19 @@ bool WebPage::render(const QString &fileName)
     if (fileName.endsWith(".pdf", Qt::CaseInsensitive))
         return renderPdf(fileName);
 
+    // PNG and JPEG are encoded while rendering, without an intermediate full-page image
+    const QByteArray format = fileInfo.suffix().toLower().toAscii();
+    if (StripEncoder::supportsFormat(format)) {
+        QFile file(fileName);
+        if (!file.open(QFile::WriteOnly))
+            return false;
+        if (!renderStreamed(&file, format)) {
+            file.remove();
+            return false;
+        }
+        return true;
+    }
+
     QImage buffer = renderImage();
     if (fileName.toLower().endsWith(".gif")) {
         return exportGif(buffer, fileName);
@@ -687,10 +853,58 @@ bool WebPage::render(const QString &fileName)
     return buffer.save(fileName);
 }
 
+bool WebPage::renderGifFrame(const QString &fileName, int delay)
+{
+    if (m_mainFrame->contentsSize().isEmpty())
+        return false;
+
+    const QFileInfo fileInfo(fileName);
+    if (!m_gifAnimation || m_gifAnimation->fileName() != fileInfo.absoluteFilePath()) {
+        finishGif();
+
+        QDir dir;
+        dir.mkpath(fileInfo.absolutePath());
+        m_gifAnimation = new GifWriter;
+        if (!m_gifAnimation->open(fileInfo.absoluteFilePath())) {
+            delete m_gifAnimation;
+            m_gifAnimation = NULL;
+            return false;
+        }
+    }
+
+    return m_gifAnimation->addFrame(renderImage(), delay);
+}
+
+int WebPage::finishGif()
+{
+    if (!m_gifAnimation)
+        return 0;
+
+    const int frames = m_gifAnimation->frameCount();
+    delete m_gifAnimation;
+    m_gifAnimation = NULL;
+    return frames;
+}
+
 QString WebPage::renderBase64(const QByteArray &format)
 {
     QByteArray nformat = format.toLower();
 
+    // PNG and JPEG are painted, encoded and base64'd one strip at a time
+    if (StripEncoder::supportsFormat(nformat)) {
+        QByteArray bytes;
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+
+        Base64Device device(&buffer);
+        device.open(QIODevice::WriteOnly);
+        if (!renderStreamed(&device, nformat))
+            return "";
+        device.close();
+
+        return bytes;
+    }
+
     // Check if the given format is supported
     if (QImageWriter::supportedImageFormats().contains(nformat)) {
         QImage rawPageRendering = renderImage();
@@ -700,72 +914,198 @@ QString WebPage::renderBase64(const QByteArray &format)
         QBuffer buffer(&bytes);
         buffer.open(QIODevice::WriteOnly);
 
-        // Writing image to the buffer, using PNG encoding
-        rawPageRendering.save(&buffer, nformat);
+        // The encoder writes straight into the base64 output, without
+        // holding the whole encoded image besides it
+        Base64Device device(&buffer);
+        device.open(QIODevice::WriteOnly);
+        if (!QImageWriter(&device, nformat).write(rawPageRendering))
+            return "";
+        device.close();
 
-        return bytes.toBase64();
+        return bytes;
     }
 
     // Return an empty string in case an unsupported format was provided
     return "";
 }
 
-QImage WebPage::renderImage()
+#ifdef Q_OS_WIN32
+#define RENDER_IMAGE_FORMAT QImage::Format_ARGB32_Premultiplied
+#else
+#define RENDER_IMAGE_FORMAT QImage::Format_ARGB32
+#endif
+
+// We use tiling approach to work-around Qt software rasterizer bug
+// when dealing with very large paint device.
+// See http://code.google.com/p/phantomjs/issues/detail?id=54.
+#define RENDER_TILE_SIZE 4096
+
+// Copies a rendered tile into its place in the destination buffer
+static void blitTile(uchar *dst, int dstBytesPerLine, const QImage &tile, const QPoint &pos)
 {
-    QSize contentsSize = m_mainFrame->contentsSize();
-    contentsSize -= QSize(m_scrollPosition.x(), m_scrollPosition.y());
-    QRect frameRect = QRect(QPoint(0, 0), contentsSize);
+    const int bytesPerPixel = tile.depth() / 8;
+    const int rowBytes = tile.width() * bytesPerPixel;
+    uchar *dstRow = dst + pos.y() * dstBytesPerLine + pos.x() * bytesPerPixel;
+    for (int row = 0; row < tile.height(); ++row) {
+        memcpy(dstRow, tile.constScanLine(row), rowBytes);
+        dstRow += dstBytesPerLine;
+    }
+}
+
+QRect WebPage::renderFrameRect(QSize *contentsSize) const
+{
+    *contentsSize = m_mainFrame->contentsSize();
+    *contentsSize -= QSize(m_scrollPosition.x(), m_scrollPosition.y());
+    QRect frameRect = QRect(QPoint(0, 0), *contentsSize);
     if (!m_clipRect.isNull())
         frameRect = m_clipRect;
+    return frameRect;
+}
 
-    QSize viewportSize = m_customWebPage->viewportSize();
-    m_customWebPage->setViewportSize(contentsSize);
+// Returns the viewport size to restore after rendering, or an invalid size
+// if the area can be painted without laying the document out again
+QSize WebPage::resizeViewportForRender(const QRect &frameRect, const QSize &contentsSize)
+{
+    const QSize viewportSize = m_customWebPage->viewportSize();
+    if (m_renderAtCurrentLayout && QRect(QPoint(0, 0), viewportSize).contains(frameRect))
+        return QSize();
 
-#ifdef Q_OS_WIN32
-    QImage::Format format = QImage::Format_ARGB32_Premultiplied;
-#else
-    QImage::Format format = QImage::Format_ARGB32;
-#endif
+    m_customWebPage->setViewportSize(contentsSize);
+    return viewportSize;
+}
 
-    QImage buffer(frameRect.size(), format);
-    buffer.fill(qRgba(255, 255, 255, 0));
+void WebPage::paintTiles(const QRect &area, QImage &buffer)
+{
+    uchar *bits = buffer.bits();
+    const int bytesPerLine = buffer.bytesPerLine();
 
     QPainter painter;
 
-    // We use tiling approach to work-around Qt software rasterizer bug
-    // when dealing with very large paint device.
-    // See http://code.google.com/p/phantomjs/issues/detail?id=54.
-    const int tileSize = 4096;
-    int htiles = (buffer.width() + tileSize - 1) / tileSize;
-    int vtiles = (buffer.height() + tileSize - 1) / tileSize;
+    // Each tile only paints its own region of the frame
+    int htiles = (area.width() + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+    int vtiles = (area.height() + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
     for (int x = 0; x < htiles; ++x) {
         for (int y = 0; y < vtiles; ++y) {
+            QRect tileRect(area.left() + x * RENDER_TILE_SIZE, area.top() + y * RENDER_TILE_SIZE,
+                           RENDER_TILE_SIZE, RENDER_TILE_SIZE);
+            tileRect &= area;
 
-            QImage tileBuffer(tileSize, tileSize, format);
+            QImage tileBuffer(tileRect.size(), buffer.format());
             tileBuffer.fill(qRgba(255, 255, 255, 0));
 
-            // Render the web page onto the small tile first
+            // Render only this tile's region of the web page
             painter.begin(&tileBuffer);
             painter.setRenderHint(QPainter::Antialiasing, true);
             painter.setRenderHint(QPainter::TextAntialiasing, true);
             painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-            painter.translate(-frameRect.left(), -frameRect.top());
-            painter.translate(-x * tileSize, -y * tileSize);
-            m_mainFrame->render(&painter, QRegion(frameRect));
+            painter.translate(-tileRect.left(), -tileRect.top());
+            m_mainFrame->render(&painter, QRegion(tileRect));
             painter.end();
 
             // Copy the tile to the main buffer
-            painter.begin(&buffer);
-            painter.setCompositionMode(QPainter::CompositionMode_Source);
-            painter.drawImage(x * tileSize, y * tileSize, tileBuffer);
-            painter.end();
+            blitTile(bits, bytesPerLine, tileBuffer, QPoint(x * RENDER_TILE_SIZE, y * RENDER_TILE_SIZE));
         }
     }
+}
+
+QImage WebPage::renderImage()
+{
+    QSize contentsSize;
+    QRect frameRect = renderFrameRect(&contentsSize);
+
+    const QSize viewportSize = resizeViewportForRender(frameRect, contentsSize);
 
-    m_customWebPage->setViewportSize(viewportSize);
+    QImage buffer(frameRect.size(), RENDER_IMAGE_FORMAT);
+    paintTiles(frameRect, buffer);
+
+    if (viewportSize.isValid())
+        m_customWebPage->setViewportSize(viewportSize);
     return buffer;
 }
 
+bool WebPage::renderStreamed(QIODevice *device, const QByteArray &format)
+{
+    QSize contentsSize;
+    QRect frameRect = renderFrameRect(&contentsSize);
+
+    const QSize viewportSize = resizeViewportForRender(frameRect, contentsSize);
+
+    // Paint and encode one row of tiles at a time, so that memory usage
+    // depends on the tile size and not on the height of the page
+    StripEncoder encoder(device, format);
+    bool ok = encoder.begin(frameRect.size());
+    for (int top = 0; ok && top < frameRect.height(); top += RENDER_TILE_SIZE) {
+        QRect stripRect(frameRect.left(), frameRect.top() + top,
+                        frameRect.width(), qMin(RENDER_TILE_SIZE, frameRect.height() - top));
+        QImage strip(stripRect.size(), RENDER_IMAGE_FORMAT);
+        paintTiles(stripRect, strip);
+        ok = encoder.write(strip);
+    }
+    ok = ok && encoder.finish();
+
+    if (viewportSize.isValid())
+        m_customWebPage->setViewportSize(viewportSize);
+    return ok;
+}
+
+// Past this many rects, the damage is tracked as their bounding rect
+#define RENDER_DAMAGE_MAX_RECTS 32
+
+void WebPage::handleRepaintRequested(const QRect &dirtyRect)
+{
+    m_damage += dirtyRect;
+    if (m_damage.rectCount() > RENDER_DAMAGE_MAX_RECTS)
+        m_damage = m_damage.boundingRect();
+}
+
+void WebPage::handleScrollRequested()
+{
+    m_damageComplete = true;
+}
+
+QVariantList WebPage::renderDamage(const QByteArray &format)
+{
+    QVariantList result;
+    const QByteArray nformat = format.toLower();
+    if (!QImageWriter::supportedImageFormats().contains(nformat))
+        return result;
+
+    QRect area(QPoint(0, 0), m_customWebPage->viewportSize());
+    if (!m_clipRect.isNull())
+        area &= m_clipRect;
+
+    // Repaints are reported in viewport coordinates: they no longer match
+    // what was captured once the viewport moved
+    const QPoint scrollPosition = m_mainFrame->scrollPosition();
+    if (m_damageComplete || area != m_damageArea || scrollPosition != m_damageScrollPosition)
+        m_damage = area;
+    m_damageComplete = false;
+    m_damageArea = area;
+    m_damageScrollPosition = scrollPosition;
+
+    const QRegion damage = m_damage & area;
+    m_damage = QRegion();
+
+    foreach (const QRect &rect, damage.rects()) {
+        QImage image(rect.size(), RENDER_IMAGE_FORMAT);
+        paintTiles(rect, image);
+
+        QByteArray bytes;
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, nformat);
+
+        QVariantMap damaged;
+        damaged["left"] = rect.left();
+        damaged["top"] = rect.top();
+        damaged["width"] = rect.width();
+        damaged["height"] = rect.height();
+        damaged["data"] = QString::fromLatin1(bytes.toBase64());
+        result += damaged;
+    }
+    return result;
+}
+
 #define PHANTOMJS_PDF_DPI 72            // Different defaults. OSX: 72, X11: 75(?), Windows: 96
 
 qreal stringToPointSize(const QString &string)
@@ -1291,7 +1631,9 @@ void WebPage::initCompletions()
     // Add completion for the Dynamic Properties of the 'webpage' object
     // properties
     addCompletion("clipRect");
+    addCompletion("renderAtCurrentLayout");
     addCompletion("content");
+    addCompletion("setContent");
     addCompletion("libraryPath");
     addCompletion("settings");
     addCompletion("viewportSize");
@@ -1303,14 +1645,22 @@ void WebPage::initCompletions()
     addCompletion("framesName");
     addCompletion("framesCount");
     addCompletion("cookies");
+    addCompletion("resourceEventFields");
+    addCompletion("blockedUrls");
+    addCompletion("networkActivity");
     // functions
     addCompletion("evaluate");
+    addCompletion("evaluateBulk");
+    addCompletion("waitForNetworkIdle");
     addCompletion("includeJs");
     addCompletion("injectJs");
     addCompletion("open");
     addCompletion("release");
     addCompletion("render");
     addCompletion("renderBase64");
+    addCompletion("renderGifFrame");
+    addCompletion("renderDamage");
+    addCompletion("finishGif");
     addCompletion("sendEvent");
     addCompletion("uploadFile");
     addCompletion("getPage");
@@ -1332,6 +1682,7 @@ void WebPage::initCompletions()
     addCompletion("onLoadFinished");
     addCompletion("onResourceRequested");
     addCompletion("onResourceReceived");
+    addCompletion("onNetworkIdle");
     addCompletion("onUrlChanged");
     addCompletion("onNavigationRequested");
     addCompletion("onError");
@@ -42,6 +42,7 @@ class Config;
 class CustomPage;
 class WebpageCallbacks;
 class NetworkAccessManager;
+class GifWriter;
 class QWebInspector;
 class Phantom;
 
@@ -60,9 +61,13 @@ class WebPage: public REPLCompletable, public QWebFrame::PrintCallback
     Q_PROPERTY(QVariantMap viewportSize READ viewportSize WRITE setViewportSize)
     Q_PROPERTY(QVariantMap paperSize READ paperSize WRITE setPaperSize)
     Q_PROPERTY(QVariantMap clipRect READ clipRect WRITE setClipRect)
+    Q_PROPERTY(bool renderAtCurrentLayout READ renderAtCurrentLayout WRITE setRenderAtCurrentLayout)
     Q_PROPERTY(QVariantMap scrollPosition READ scrollPosition WRITE setScrollPosition)
     Q_PROPERTY(bool navigationLocked READ navigationLocked WRITE setNavigationLocked)
     Q_PROPERTY(QVariantMap customHeaders READ customHeaders WRITE setCustomHeaders)
+    Q_PROPERTY(QStringList resourceEventFields READ resourceEventFields WRITE setResourceEventFields)
+    Q_PROPERTY(QStringList blockedUrls READ blockedUrls WRITE setBlockedUrls)
+    Q_PROPERTY(QVariantMap networkActivity READ networkActivity)
     Q_PROPERTY(qreal zoomFactor READ zoomFactor WRITE setZoomFactor)
     Q_PROPERTY(QVariantList cookies READ cookies WRITE setCookies)
     Q_PROPERTY(QString windowName READ windowName)
@@ -104,6 +109,19 @@ public:
     void setClipRect(const QVariantMap &size);
     QVariantMap clipRect() const;
 
+    /**
+     * When set, a render whose area (the clipRect, or the whole document if
+     * there is none) is within the viewport paints just that area at the
+     * current layout, instead of laying the document out again in a viewport
+     * the size of the whole document and back. Areas out of the viewport are
+     * still rendered the usual way.
+     *
+     * @brief setRenderAtCurrentLayout
+     * @param enabled
+     */
+    void setRenderAtCurrentLayout(const bool enabled);
+    bool renderAtCurrentLayout() const;
+
     void setScrollPosition(const QVariantMap &size);
     QVariantMap scrollPosition() const;
 
@@ -116,8 +134,56 @@ public:
     void setCustomHeaders(const QVariantMap &headers);
     QVariantMap customHeaders() const;
 
+    /**
+     * Restricts the fields of the objects passed to "onResourceRequested" and
+     * "onResourceReceived" (e.g. <code>["url", "status", "timings"]</code>):
+     * "id" and "stage" are always there. An empty list means all the fields.
+     *
+     * @brief setResourceEventFields
+     * @param fields Names of the fields to report
+     */
+    void setResourceEventFields(const QStringList &fields);
+    QStringList resourceEventFields() const;
+
+    /**
+     * Requests to URLs matching these rules fail right away, without any
+     * resource event: hosts (with their subdomains), URL prefixes or wildcard
+     * patterns, e.g. <code>["ads.example.com", "http://example.com/track/", "*.woff"]</code>.
+     * The rules of '--url-blocklist' apply too.
+     *
+     * @brief setBlockedUrls
+     * @param rules Blocklist rules
+     */
+    void setBlockedUrls(const QStringList &rules);
+    QStringList blockedUrls() const;
+
+    /**
+     * Requests of this page not finished yet ("inflight"), those of them
+     * already receiving data ("receiving"), and all the requests it made ("requested").
+     *
+     * @brief networkActivity
+     * @return Map of the request counters
+     */
+    QVariantMap networkActivity() const;
+
+    /**
+     * Resource events are only built when something is connected to them.
+     */
+    bool hasResourceRequestedHandlers() const;
+    bool hasResourceReceivedHandlers() const;
+
     void showInspector(const int remotePort = -1);
 
+    /**
+     * Brings a used page back to the state of a freshly created one, so it
+     * can be handed out again (see Phantom::recycleWebPage()): stops loading,
+     * closes the child pages, clears the content, the history and the
+     * callbacks, disconnects the script handlers and restores viewport,
+     * clip rect, zoom and the per-page network settings.
+     * The QWebSettings and storage paths are kept as they are.
+     */
+    void reset();
+
     QString footer(int page, int numPages);
     qreal footerHeight() const;
     QString header(int page, int numPages);
@@ -228,6 +294,16 @@ public slots:
     void close();
 
     QVariant evaluateJavaScript(const QString &code);
+    /**
+     * Set the content of the page as if it had been loaded from "baseUrl":
+     * relative URLs, the location and the cookies visible to the page
+     * all depend on it. Nothing is requested from "baseUrl" itself.
+     *
+     * @brief setContent
+     * @param content HTML of the page
+     * @param baseUrl URL the page appears to come from
+     */
+    void setContent(const QString &content, const QString &baseUrl);
     bool render(const QString &fileName);
     /**
      * Render the page as base-64 encoded string.
@@ -242,8 +318,50 @@ public slots:
      * @return Rendering base-64 encoded of the page if the given format is supported, otherwise an empty string
      */
     QString renderBase64(const QByteArray &format = "png");
+    /**
+     * Render the page and append it as a frame of an animated GIF.
+     * The first call for a file starts it, quantizing the palette out of
+     * that first frame; the following ones add frames until finishGif()
+     * is called, another file is started or the page is closed.
+     *
+     * @brief renderGifFrame
+     * @param fileName Path of the animated GIF
+     * @param delay How long the frame is shown (in ms)
+     * @return true if the frame was written
+     */
+    bool renderGifFrame(const QString &fileName, int delay = 100);
+    /**
+     * Render only what the page repainted since the previous call, within
+     * the viewport (and the clipRect, if set), at the current layout.
+     * The first call, and any after the viewport was resized or scrolled,
+     * returns the whole area.
+     *
+     * @brief renderDamage
+     * @param format Image format of the rects, as for renderBase64
+     * @return List of {left, top, width, height, data} objects, where the position is in viewport coordinates and data is the base-64 encoded image
+     */
+    QVariantList renderDamage(const QByteArray &format = "png");
+    /**
+     * Complete the animated GIF started by renderGifFrame().
+     *
+     * @brief finishGif
+     * @return Number of frames written, 0 if there was no animated GIF
+     */
+    int finishGif();
+    /**
+     * Fire "onNetworkIdle" once, as soon as at most maxInflight requests of
+     * the page have been in flight for quietMs without change. Replaces
+     * the previous wait; a negative quietMs cancels it.
+     *
+     * @brief waitForNetworkIdle
+     * @param quietMs Milliseconds the network has to stay quiet
+     * @param maxInflight Requests that may still be in flight
+     */
+    void waitForNetworkIdle(int quietMs = 500, int maxInflight = 0);
     bool injectJs(const QString &jsFilePath);
     void _appendScriptElement(const QString &scriptUrl);
+    QVariant _evaluateFunction(const QString &function, const QVariantList &args);
+    QVariant _evaluateFunctionBulk(const QString &function, const QVariantList &args);
     QObject *_getGenericCallback();
     QObject *_getJsConfirmCallback();
     QObject *_getJsPromptCallback();
@@ -405,6 +523,7 @@ signals:
     void javaScriptErrorSent(const QString &msg, const QString &stack);
     void resourceRequested(const QVariant &req);
     void resourceReceived(const QVariant &resource);
+    void networkIdle(int quietMs, int maxInflight);
     void urlChanged(const QUrl &url);
     void navigationRequested(const QUrl &url, const QString &navigationType, bool navigationLocked, bool isMainFrame);
     void rawPageCreated(QObject *page);
@@ -413,9 +532,15 @@ signals:
 private slots:
     void finish(bool ok);
     void handleJavaScriptWindowObjectCleared();
+    void handleRepaintRequested(const QRect &dirtyRect);
+    void handleScrollRequested();
 
 private:
+    QRect renderFrameRect(QSize *contentsSize) const;
+    QSize resizeViewportForRender(const QRect &frameRect, const QSize &contentsSize);
+    void paintTiles(const QRect &area, QImage &buffer);
     QImage renderImage();
+    bool renderStreamed(QIODevice *device, const QByteArray &format);
     bool renderPdf(const QString &fileName);
     void applySettings(const QVariantMap &defaultSettings);
     QString userAgent() const;
@@ -439,12 +564,18 @@ private:
     QWebFrame *m_mainFrame;
     QWebFrame *m_currentFrame;
     QRect m_clipRect;
+    bool m_renderAtCurrentLayout;
+    QRegion m_damage; // Repainted since the last renderDamage()
+    bool m_damageComplete;
+    QRect m_damageArea;
+    QPoint m_damageScrollPosition;
     QPoint m_scrollPosition;
     QVariantMap m_paperSize; // For PDF output via render()
     QString m_libraryPath;
     QWebInspector* m_inspector;
     WebpageCallbacks *m_callbacks;
     bool m_navigationLocked;
+    GifWriter *m_gifAnimation;
     QPoint m_mousePos;
     bool m_ownsPages;
 
@@ -31,9 +31,11 @@
 
 #include "webserver.h"
 
+#include "encoding.h"
 #include "mongoose/mongoose.h"
 
 #include <QByteArray>
+#include <QFile>
 #include <QHostAddress>
 #include <QMetaType>
 #include <QThread>
@@ -41,6 +43,11 @@
 #include <QVector>
 #include <QDebug>
 
+// Size of the chunks request bodies are read in
+#define REQUEST_BODY_CHUNK_SIZE 8192
+// Time in ms after which a response the script never closed is closed for it (0: never)
+#define DEFAULT_RESPONSE_TIMEOUT 0
+
 namespace UrlEncodedParser {
 
 QString unescape(QByteArray in)
@@ -78,6 +85,18 @@ QVariantMap parse(const QByteArray &data) {
 
 }
 
+// Read the request body in chunks, mongoose stops at the Content-Length
+static QByteArray readRequestBody(mg_connection *conn)
+{
+    QByteArray body;
+    char buffer[REQUEST_BODY_CHUNK_SIZE];
+    int read;
+    while ((read = mg_read(conn, buffer, sizeof(buffer))) > 0) {
+        body.append(buffer, read);
+    }
+    return body;
+}
+
 static void *callback(mg_event event,
                       mg_connection *conn,
                       const mg_request_info *request)
@@ -94,6 +113,9 @@ static void *callback(mg_event event,
 WebServer::WebServer(QObject *parent)
     : REPLCompletable(parent)
     , m_ctx(0)
+    , m_keepAlive(false)
+    , m_streamRequestBody(false)
+    , m_responseTimeout(DEFAULT_RESPONSE_TIMEOUT)
 {
     setObjectName("WebServer");
     qRegisterMetaType<WebServerResponse*>("WebServerResponse*");
@@ -110,11 +132,24 @@ bool WebServer::listenOnPort(const QString& port, const QVariantMap& opts)
 
     // Create options vector
     QVector<const char*> options;
-    options <<  "listening_ports" << qstrdup(qPrintable(port));
+    const QString sslCertificate = opts.value("sslCertificate").toString();
+    if (sslCertificate.isEmpty()) {
+        options <<  "listening_ports" << qstrdup(qPrintable(port));
+    } else {
+        // mongoose serves HTTPS on the ports suffixed with "s"
+        options <<  "listening_ports" << qstrdup(qPrintable(port + "s"));
+        options << "ssl_certificate" << qstrdup(QFile::encodeName(sslCertificate).constData());
+    }
     options << "enable_directory_listing" << "no";
-    if (opts.value("keepAlive", false).toBool()) {
+    m_keepAlive = opts.value("keepAlive", false).toBool();
+    if (m_keepAlive) {
         options << "enable_keep_alive" << "yes";
     }
+    if (opts.contains("numThreads")) {
+        options << "num_threads" << qstrdup(qPrintable(QString::number(opts.value("numThreads").toInt())));
+    }
+    m_streamRequestBody = opts.value("streamRequestBody", false).toBool();
+    m_responseTimeout = opts.value("responseTimeout", DEFAULT_RESPONSE_TIMEOUT).toInt();
     options << NULL;
 
     // Start the server
@@ -136,20 +171,29 @@ void WebServer::close()
 {
     if (m_ctx) {
         m_closing = 1;
+        QList<WebServerResponse*> pendingResponses;
         {
-            // make sure we wake up all pending responses, such that mg_stop()
-            // can be called without deadlocking
             QMutexLocker lock(&m_mutex);
-            foreach(WebServerResponse* response, m_pendingResponses) {
-                response->close();
-            }
+            pendingResponses.swap(m_pendingResponses);
+        }
+        // make sure we wake up all pending responses and close all detached
+        // connections, such that mg_stop() can be called without deadlocking
+        foreach(WebServerResponse* response, pendingResponses) {
+            response->close();
         }
         mg_stop(m_ctx);
         m_ctx = 0;
         m_port.clear();
+        m_closing = 0;
     }
 }
 
+void WebServer::removePendingResponse(WebServerResponse *response)
+{
+    QMutexLocker lock(&m_mutex);
+    m_pendingResponses.removeOne(response);
+}
+
 bool WebServer::handleRequest(mg_event event, mg_connection *conn, const mg_request_info *request)
 {
     if (event != MG_NEW_REQUEST) {
@@ -203,66 +247,79 @@ bool WebServer::handleRequest(mg_event event, mg_connection *conn, const mg_requ
     requestObject["headers"] = headersObject;
 
     // Read request body ONLY for POST and PUT, and ONLY if the "Content-Length" is provided
-    if ((requestObject["method"] == "POST" || requestObject["method"] == "PUT") && headersObject.contains("Content-Length")) {
+    if (!m_streamRequestBody && (requestObject["method"] == "POST" || requestObject["method"] == "PUT") && headersObject.contains("Content-Length")) {
         bool contentLengthKnown = false;
-        uint contentLength = headersObject["Content-Length"].toUInt(&contentLengthKnown);
+        headersObject["Content-Length"].toUInt(&contentLengthKnown);
 
         qDebug() << "HTTP Request - Method POST/PUT";
 
         // Proceed only if we were able to read the "Content-Length"
         if (contentLengthKnown) {
-            ++contentLength; //< make space for null termination
-            char *data = new char[contentLength];
-            int read = mg_read(conn, data, contentLength);
-            data[read] = '\0'; //< adding null termination (no arm if it's already there)
+            const QByteArray data = readRequestBody(conn);
 
-            qDebug() << "HTTP Request - Content Body:" << qPrintable(data);
+            qDebug() << "HTTP Request - Content Body:" << data.constData();
 
             // Check if the 'Content-Type' requires decoding
             if (headersObject["Content-Type"] == "application/x-www-form-urlencoded") {
-                requestObject["post"] = UrlEncodedParser::parse(QByteArray(data, read));
-                requestObject["postRaw"] = QString::fromLocal8Bit(data, read);
+                requestObject["post"] = UrlEncodedParser::parse(data);
+                requestObject["postRaw"] = QString::fromLocal8Bit(data.constData(), data.size());
             } else {
-                requestObject["post"] = QString::fromLocal8Bit(data, read);
+                requestObject["post"] = QString::fromLocal8Bit(data.constData(), data.size());
             }
-            delete[] data;
         } else {
             qWarning() << "HTTP Request - Malformed 'Content-Length'";
         }
     }
 
-    // Emit signal that is catched by the PhantomJS callback,
-    // then wait until response.close() was called from
-    // the PhantomJS script.
+    // Emit signal that is catched by the PhantomJS callback.
+    //
+    // Without keep-alive the connection is detached and handed over to the
+    // response object, so this worker thread is free for the next client as
+    // soon as we return. With keep-alive mongoose needs the worker to serve
+    // further requests on the same connection, so we wait until
+    // response.close() was called from the PhantomJS script.
     //
     // This is achieved using the wait semaphore, which is
     // acquired here, in the background thread, and released
     // in WebServerResponse::close() i.e. the foreground thread
     QSemaphore wait;
-    WebServerResponse responseObject(conn, &wait);
-    responseObject.moveToThread(thread());
-
+    WebServerResponse *responseObject;
     {
-        if (m_closing) {
-            return false;
-        }
         QMutexLocker lock(&m_mutex);
         if (m_closing) {
             return false;
         }
-        m_pendingResponses << (&responseObject);
+        if (!m_keepAlive) {
+            mg_detach(conn);
+        }
+        responseObject = new WebServerResponse(this, conn, m_keepAlive ? &wait : 0, m_streamRequestBody);
+        responseObject->moveToThread(thread());
+        m_pendingResponses << responseObject;
     }
-    newRequest(requestObject, &responseObject);
-    wait.acquire();
-    {
-        if (m_closing) {
-            return false;
+    if (m_responseTimeout > 0) {
+        QMetaObject::invokeMethod(responseObject, "startCloseTimer", Qt::QueuedConnection,
+                                  Q_ARG(int, m_responseTimeout));
+    }
+    newRequest(requestObject, responseObject);
+
+    if (m_streamRequestBody) {
+        // The chunks are queued behind newRequest(), so the script
+        // had a chance to connect to requestData() when they arrive.
+        char buffer[REQUEST_BODY_CHUNK_SIZE];
+        int read;
+        while ((read = responseObject->readRequestData(buffer, sizeof(buffer))) > 0) {
+            QMetaObject::invokeMethod(responseObject, "deliverRequestData", Qt::QueuedConnection,
+                                      Q_ARG(QByteArray, QByteArray(buffer, read)));
         }
-        QMutexLocker lock(&m_mutex);
+        responseObject->finishRequestData();
+        QMetaObject::invokeMethod(responseObject, "deliverRequestEnd", Qt::QueuedConnection);
+    }
+
+    if (m_keepAlive) {
+        wait.acquire();
         if (m_closing) {
             return false;
         }
-        m_pendingResponses.removeOne(&responseObject);
     }
     return true;
 }
@@ -282,13 +339,66 @@ void WebServer::initCompletions()
 
 //BEGIN WebServerResponse
 
-WebServerResponse::WebServerResponse(mg_connection* conn, QSemaphore* close)
+WebServerResponse::WebServerResponse(WebServer *server, mg_connection* conn, QSemaphore* close, bool streamRequestBody)
     : REPLCompletable()
+    , m_server(server)
     , m_conn(conn)
     , m_statusCode(200)
     , m_headersSent(false)
+    , m_chunked(false)
     , m_close(close)
+    , m_requestBodyPending(streamRequestBody)
+    , m_reading(streamRequestBody)
+    , m_closeTimer(this)
+{
+    m_closeTimer.setSingleShot(true);
+    connect(&m_closeTimer, SIGNAL(timeout()), this, SLOT(closeOnTimeout()));
+}
+
+bool WebServerResponse::isClosed() const
+{
+    return m_closed;
+}
+
+int WebServerResponse::readRequestData(char *buffer, int size)
+{
+    if (isClosed()) {
+        return 0;
+    }
+    // no lock needed, the foreground thread keeps off m_conn while m_reading is set
+    return mg_read(m_conn, buffer, size);
+}
+
+void WebServerResponse::finishRequestData()
+{
+    QMutexLocker lock(&m_connMutex);
+    m_reading = false;
+    if (!m_pendingOutput.isEmpty()) {
+        mg_write(m_conn, m_pendingOutput.constData(), m_pendingOutput.size());
+        m_pendingOutput.clear();
+    }
+    if (isClosed()) {
+        releaseConnection();
+    }
+}
+
+void WebServerResponse::send(const QByteArray &data)
+{
+    QMutexLocker lock(&m_connMutex);
+    if (m_reading) {
+        m_pendingOutput.append(data);
+    } else {
+        mg_write(m_conn, data.constData(), data.size());
+    }
+}
+
+void WebServerResponse::releaseConnection()
 {
+    if (m_close) {
+        m_close->release();
+    } else {
+        mg_close_connection(m_conn);
+    }
 }
 
 const char* responseCodeString(int code)
@@ -386,32 +496,84 @@ void WebServerResponse::writeHead(int statusCode, const QVariantMap &headers)
 {
     ///TODO: what is the best-practice error handling in javascript? exceptions?
     Q_ASSERT(!m_headersSent);
+    if (isClosed()) {
+        return;
+    }
     m_headersSent = true;
     m_statusCode = statusCode;
-    mg_printf(m_conn, "HTTP/1.1 %d %s\r\n", m_statusCode, responseCodeString(m_statusCode));
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(m_statusCode) + ' ' + responseCodeString(m_statusCode) + "\r\n";
     qDebug() << "HTTP Response - Status Code" << m_statusCode << responseCodeString(m_statusCode);
     QVariantMap::const_iterator it = headers.constBegin();
     while(it != headers.constEnd()) {
         qDebug() << "HTTP Response - Sending Header" << it.key() << "=" << it.value().toString();
-        mg_printf(m_conn, "%s: %s\r\n", qPrintable(it.key()), qPrintable(it.value().toString()));
+        head += it.key().toLocal8Bit() + ": " + it.value().toString().toLocal8Bit() + "\r\n";
+        if (it.key().compare("Transfer-Encoding", Qt::CaseInsensitive) == 0) {
+            m_chunked = it.value().toString().compare("chunked", Qt::CaseInsensitive) == 0;
+        }
         ++it;
     }
-    mg_write(m_conn, "\r\n", 2);
+    head += "\r\n";
+    send(head);
 }
 
 void WebServerResponse::write(const QString &body)
 {
+    if (isClosed()) {
+        return;
+    }
     if (!m_headersSent) {
         writeHead(m_statusCode, m_headers);
     }
-    ///TODO: encoding?!
-    const QByteArray data = body.toLocal8Bit();
-    mg_write(m_conn, data.constData(), data.size());
+
+    QByteArray data;
+    if (m_encoding.isEmpty()) {
+        data = body.toLocal8Bit();
+    } else if (m_encoding.compare("binary", Qt::CaseInsensitive) == 0) {
+        data = body.toLatin1();
+    } else {
+        data = Encoding(m_encoding).encode(body);
+    }
+
+    if (m_chunked) {
+        // an empty chunk would terminate the body
+        if (data.isEmpty()) {
+            return;
+        }
+        send(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n");
+    } else {
+        send(data);
+    }
+}
+
+void WebServerResponse::setEncoding(const QString &encoding)
+{
+    m_encoding = encoding;
 }
 
 void WebServerResponse::close()
 {
-    m_close->release();
+    if (!m_closed.testAndSetOrdered(0, 1)) {
+        return;
+    }
+    m_closeTimer.stop();
+    if (m_chunked) {
+        send("0\r\n\r\n");
+    }
+
+    m_server->removePendingResponse(this);
+    {
+        QMutexLocker lock(&m_connMutex);
+        // a streaming worker blocked in mg_read() still owns the connection,
+        // it releases it in finishRequestData() once the read returns
+        if (!m_reading) {
+            releaseConnection();
+        }
+    }
+
+    // a streaming worker still queues request data to us
+    if (!m_requestBodyPending) {
+        deleteLater();
+    }
 }
 
 void WebServerResponse::closeGracefully()
@@ -432,6 +594,39 @@ void WebServerResponse::setStatusCode(int code)
     m_statusCode = code;
 }
 
+void WebServerResponse::startCloseTimer(int timeout)
+{
+    if (!isClosed()) {
+        m_closeTimer.start(timeout);
+    }
+}
+
+void WebServerResponse::closeOnTimeout()
+{
+    qWarning() << "HTTP Response - Not closed within" << m_closeTimer.interval() << "ms, closing it";
+    if (!m_headersSent) {
+        writeHead(504, m_headers);
+    }
+    close();
+}
+
+void WebServerResponse::deliverRequestData(const QByteArray &chunk)
+{
+    if (!isClosed()) {
+        emit requestData(QString::fromLatin1(chunk.constData(), chunk.size()));
+    }
+}
+
+void WebServerResponse::deliverRequestEnd()
+{
+    m_requestBodyPending = false;
+    if (isClosed()) {
+        deleteLater();
+    } else {
+        emit requestEnd();
+    }
+}
+
 QString WebServerResponse::header(const QString &name) const
 {
     return m_headers.value(name).toString();
@@ -465,6 +660,11 @@ void WebServerResponse::initCompletions()
     // functions
     addCompletion("writeHead");
     addCompletion("write");
+    addCompletion("setEncoding");
+    addCompletion("close");
+    // callbacks
+    addCompletion("requestData");
+    addCompletion("requestEnd");
 }
 
 //END WebServerResponse
@@ -34,6 +34,8 @@
 #include <QVariantMap>
 #include <QMutex>
 #include <QSemaphore>
+#include <QAtomicInt>
+#include <QTimer>
 
 #include "mongoose.h"
 #include "replcompletable.h"
@@ -63,6 +65,19 @@ public slots:
      * For each new request @c handleRequest() will be called which
      * in turn emits @c newRequest() where appropriate.
      *
+     * Supported @p options:
+     *  - keepAlive: keep connections open between requests; each
+     *    pending response then occupies a worker thread until closed.
+     *  - numThreads: size of the worker thread pool.
+     *  - sslCertificate: path of a PEM file holding the certificate
+     *    and the private key; the server then speaks HTTPS.
+     *  - responseTimeout: time in ms after which a response that the
+     *    script did not close is closed for it, with status 504 if no
+     *    headers were sent yet. Defaults to 0: responses stay open
+     *    until the script closes them.
+     *  - streamRequestBody: deliver the request body in chunks through
+     *    WebServerResponse::requestData() instead of request.post.
+     *
      * @return true if we can listen on @p port, false otherwise.
      *
      * WARNING: must not be the same name as in the javascript api...
@@ -83,6 +98,8 @@ signals:
 
 public:
     bool handleRequest(mg_event event, mg_connection *conn, const mg_request_info *request);
+    /// Forget about @p response, called once it has been closed.
+    void removePendingResponse(WebServerResponse *response);
 
 private:
     virtual void initCompletions();
@@ -93,11 +110,19 @@ private:
     QMutex m_mutex;
     QList<WebServerResponse*> m_pendingResponses;
     QAtomicInt m_closing;
+    bool m_keepAlive;
+    bool m_streamRequestBody;
+    int m_responseTimeout;
 };
 
 
 /**
  * Outgoing HTTP response to client.
+ *
+ * Without keep-alive the connection is detached from its mongoose worker
+ * thread, so a response can stay open for as long as the script needs
+ * without holding up other clients. With keep-alive the worker waits on
+ * @c close() instead.
  */
 class WebServerResponse : public REPLCompletable
 {
@@ -106,19 +131,50 @@ class WebServerResponse : public REPLCompletable
     Q_PROPERTY(int statusCode READ statusCode WRITE setStatusCode)
     Q_PROPERTY(QVariantMap headers READ headers WRITE setHeaders)
 public:
-    WebServerResponse(mg_connection *conn, QSemaphore* close);
+    /// @p close is the semaphore a keep-alive worker waits on, or 0 if
+    /// @p conn has been detached
+    WebServerResponse(WebServer *server, mg_connection *conn, QSemaphore* close, bool streamRequestBody);
+
+    /// true once the script has closed the response, thread safe
+    bool isClosed() const;
+
+    /**
+     * Read the next chunk of a streamed request body into @p buffer,
+     * called from the mongoose worker thread.
+     *
+     * Until @c finishRequestData() the worker owns the connection: output
+     * is buffered and @c close() leaves releasing the connection to it.
+     *
+     * @return the number of bytes read, 0 at the end of the body or
+     *         once the response has been closed.
+     */
+    int readRequestData(char *buffer, int size);
+    /// Hand the connection back after the last @c readRequestData().
+    void finishRequestData();
 
 public slots:
     /// send @p headers to client with status code @p statusCode
     void writeHead(int statusCode, const QVariantMap &headers);
-    /// sends @p data to client and makes sure the headers are send beforehand
+    /**
+     * Sends @p data to client and makes sure the headers are send beforehand.
+     *
+     * The data is encoded according to @c setEncoding(). If the
+     * "Transfer-Encoding" header is "chunked", every call sends one chunk.
+     */
     void write(const QString &data);
 
+    /**
+     * Set the encoding used by @c write(), the local 8-bit encoding by default.
+     *
+     * Use "binary" to send a string whose characters are bytes.
+     */
+    void setEncoding(const QString &encoding);
+
     /**
      * Closes the request once all data has been written to the client.
      *
-     * NOTE: This MUST be called, otherwise the server will
-     *       not allow new connections anymore.
+     * NOTE: This MUST be called, otherwise the connection stays
+     *       open until the responseTimeout of the server expires.
      *
      * NOTE: After calling close(), this request object
      *       is no longer valid. Any further calls are
@@ -144,15 +200,41 @@ public slots:
     /// set all headers
     void setHeaders(const QVariantMap &headers);
 
+signals:
+    /// a chunk of the request body as binary string, see streamRequestBody
+    void requestData(const QString &chunk);
+    /// the request body has been received completely
+    void requestEnd();
+
+private slots:
+    void startCloseTimer(int timeout);
+    void closeOnTimeout();
+    void deliverRequestData(const QByteArray &chunk);
+    void deliverRequestEnd();
+
 private:
     virtual void initCompletions();
+    /// write @p data to the client, or buffer it while the worker reads
+    void send(const QByteArray &data);
+    /// let go of m_conn, the caller must hold m_connMutex
+    void releaseConnection();
 
 private:
+    WebServer *m_server;
     mg_connection *m_conn;
     int m_statusCode;
     QVariantMap m_headers;
     bool m_headersSent;
+    bool m_chunked;
+    QString m_encoding;
     QSemaphore* m_close;
+    QAtomicInt m_closed;
+    bool m_requestBodyPending;
+    /// guards m_reading, m_pendingOutput and every use of m_conn
+    QMutex m_connMutex;
+    bool m_reading;
+    QByteArray m_pendingOutput;
+    QTimer m_closeTimer;
 };
 
 #endif // WEBSERVER_H
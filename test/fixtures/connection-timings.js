@@ -0,0 +1,32 @@
+// Opens the URL given as argument in two pages, one after the other, and prints
+// the connection timings of both main resources for the "phantom connections" specs
+var url = require('system').args[1];
+// Both pages stay open: with shared connections, closing the last page ends the pool
+var timings = [];
+var pages = [];
+
+function open(done) {
+    var page = require('webpage').create();
+    pages.push(page);
+    page.onResourceReceived = function (response) {
+        if (response.stage === 'end' && response.url === url) {
+            timings.push({
+                connect: response.timings.connect,
+                ssl: response.timings.ssl,
+                sslResumed: response.timings.sslResumed
+            });
+        }
+    };
+    page.open(url, done);
+}
+
+open(function (status) {
+    if (status !== 'success') {
+        console.log(JSON.stringify({ error: status }));
+        phantom.exit(1);
+    }
+    open(function () {
+        console.log(JSON.stringify(timings));
+        phantom.exit();
+    });
+});
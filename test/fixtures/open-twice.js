@@ -0,0 +1,24 @@
+// Opens the URL given as argument, and again in a new page after the given
+// delay (ms), then prints both statuses for the "phantom host name cache" specs
+var system = require('system');
+var url = system.args[1];
+var delay = Number(system.args[2] || 0);
+var statuses = [];
+
+function open(done) {
+    var page = require('webpage').create();
+    page.open(url, function (status) {
+        statuses.push(status);
+        page.close();
+        done();
+    });
+}
+
+open(function () {
+    setTimeout(function () {
+        open(function () {
+            console.log(JSON.stringify(statuses));
+            phantom.exit();
+        });
+    }, delay);
+});
@@ -0,0 +1,13 @@
+// Sets a page whose parser blocks on a script that never arrives, and exits
+// once it was requested: only the preload scanner saw the image after it
+var port = require('system').args[1];
+var page = require('webpage').create();
+page.onResourceRequested = function (request) {
+    if (/\/never\.js$/.test(request.url)) {
+        setTimeout(function () {
+            phantom.exit();
+        }, 1000);
+    }
+};
+page.content = '<html><body><script src="http://127.0.0.1:' + port + '/never.js"></script>' +
+    '<img src="http://localhost:' + port + '/image.png"></body></html>';
@@ -0,0 +1,10 @@
+// Prints the settings that "phantom '--config' JSON parser" specs pass through a config file
+var settings = phantom.defaultPageSettings;
+console.log(JSON.stringify({
+    diskCacheEnabled: phantom.diskCacheEnabled,
+    outputEncoding: phantom.outputEncoding,
+    webSecurityEnabled: settings.webSecurityEnabled,
+    maxConnectionsPerHost: settings.maxConnectionsPerHost,
+    hostConnections: settings.hostConnections
+}));
+phantom.exit();
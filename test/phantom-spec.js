@@ -71,4 +71,569 @@ describe("phantom global object", function() {
         expect(phantom.hasOwnProperty('cookiesEnabled')).toBeTruthy();
         expect(phantom.cookiesEnabled).toBeTruthy();
     });
+
+    it("should have 'proxyAutoConfigStatistics' property, empty without '--pac'", function() {
+        expect(phantom.hasOwnProperty('proxyAutoConfigStatistics')).toBeTruthy();
+        expect(phantom.proxyAutoConfigStatistics).toEqual({});
+    });
+
+    it("should prefetch each host name once", function() {
+        expect(phantom.prefetchHosts(['localhost', 'LOCALHOST', ' localhost', '127.0.0.1'])).toEqual(2);
+        expect(phantom.prefetchHosts([])).toEqual(0);
+    });
+
+    it("should report the memory cache content and prune it", function() {
+        var server = require('webserver').create();
+        var page = require('webpage').create();
+        var before, loaded = false;
+        // 1x1 PNG
+        var image = atob("iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAYAAAAfFcSJAAAADUlEQVR42mNk+M9QDwADhgGAWjR9awAAAABJRU5ErkJggg==");
+
+        runs(function() {
+            server.listen(12345, function (request, response) {
+                if (request.url === "/cached.png") {
+                    response.writeHead(200, { "Content-Type": "image/png", "Cache-Control": "max-age=3600" });
+                    response.setEncoding("binary");
+                    response.write(image);
+                } else {
+                    response.writeHead(200, { "Content-Type": "text/html" });
+                    response.write('<html><body><img src="/cached.png"></body></html>');
+                }
+                response.close();
+            });
+            before = phantom.memoryCacheStatistics();
+            page.open("http://localhost:12345/memory-cache", function () {
+                loaded = true;
+            });
+        });
+
+        waitsFor(function () {
+            return loaded;
+        }, "the page with an image to load", 3000);
+
+        runs(function() {
+            var stats = phantom.memoryCacheStatistics();
+            expect(stats.images.count).toEqual(before.images.count + 1);
+            expect(stats.images.size).toBeGreaterThan(before.images.size);
+            expect(stats.images.liveSize).toBeGreaterThan(0);
+
+            page.close();
+            server.close();
+        });
+
+        // the page is deleted later
+        waits(100);
+
+        runs(function() {
+            // once no page uses it, the image can be pruned
+            phantom.pruneMemoryCache();
+            var stats = phantom.memoryCacheStatistics();
+            expect(stats.images.count).toEqual(before.images.count);
+            expect(stats.pageCache.count).toEqual(0);
+        });
+    });
+
+    it("should serve a fresh resource from the disk cache", function() {
+        var server = require('webserver').create();
+        var url = "http://localhost:12345/disk-cached?" + Date.now();
+        var requests = 0, loads = 0, before;
+
+        var load = function () {
+            var page = require('webpage').create();
+            page.open(url, function () {
+                page.close();
+                ++loads;
+            });
+        };
+
+        runs(function() {
+            expect(phantom.diskCacheEnabled).toEqual(false);
+            expect(phantom.diskCacheStatistics).toEqual({});
+            phantom.diskCacheEnabled = true;
+            before = phantom.diskCacheStatistics;
+
+            server.listen(12345, function (request, response) {
+                ++requests;
+                response.writeHead(200, { "Content-Type": "text/html", "Cache-Control": "max-age=3600" });
+                response.write("<html><body>cached</body></html>");
+                response.close();
+            });
+            load();
+        });
+
+        waitsFor(function () {
+            return loads === 1;
+        }, "the first load", 3000);
+
+        runs(function() {
+            var stats = phantom.diskCacheStatistics;
+            expect(stats.misses).toBeGreaterThan(before.misses);
+            expect(stats.entries).toEqual(before.entries + 1);
+            expect(stats.size).toBeGreaterThan(before.size);
+            before = stats;
+            load();
+        });
+
+        waitsFor(function () {
+            return loads === 2;
+        }, "the second load", 3000);
+
+        runs(function() {
+            expect(requests).toEqual(1);
+            expect(phantom.diskCacheStatistics.hits).toBeGreaterThan(before.hits);
+            server.close();
+            phantom.diskCacheEnabled = false;
+        });
+    });
+
+    it("should change the memory cache capacities", function() {
+        var initial = phantom.memoryCacheStatistics();
+
+        // in KB, like "--memory-cache-size"
+        phantom.setMemoryCacheCapacities({ size: 4096, minDeadSize: 1024, maxDeadSize: 2048, pageCache: 2 });
+        var stats = phantom.memoryCacheStatistics();
+        expect(stats.capacities).toEqual({ size: 4096, minDeadSize: 1024, maxDeadSize: 2048 });
+        expect(stats.pageCache.capacity).toEqual(2);
+
+        // missing keys are kept, dead capacities never exceed the total
+        phantom.setMemoryCacheCapacities({ size: 1024 });
+        stats = phantom.memoryCacheStatistics();
+        expect(stats.capacities).toEqual({ size: 1024, minDeadSize: 1024, maxDeadSize: 1024 });
+        expect(stats.pageCache.capacity).toEqual(2);
+
+        phantom.setMemoryCacheCapacities({
+            size: initial.capacities.size,
+            minDeadSize: initial.capacities.minDeadSize,
+            maxDeadSize: initial.capacities.maxDeadSize,
+            pageCache: initial.pageCache.capacity
+        });
+        expect(phantom.memoryCacheStatistics().capacities).toEqual(initial.capacities);
+    });
+
+    it("should report the time spent starting up", function() {
+        var timings = phantom.startupTimings;
+        expect(timings.total).toBeGreaterThan(0);
+        expect(timings.hasOwnProperty('config')).toBeTruthy();
+        expect(timings.hasOwnProperty('bootstrap')).toBeTruthy();
+    });
+
+    it("should cache injected scripts until their content changes", function() {
+        var fs = require('fs');
+        var script = "temp-script-cache.js";
+        var stats = function () {
+            return phantom.scriptCacheStatistics;
+        };
+
+        fs.write(script, "window.scriptCacheSpec = 1;", "w");
+        var before = stats();
+        expect(phantom.injectJs(script)).toEqual(true);
+        expect(window.scriptCacheSpec).toEqual(1);
+        expect(stats().misses).toEqual(before.misses + 1);
+        expect(stats().entries).toEqual(before.entries + 1);
+
+        // unchanged: served from the cache
+        window.scriptCacheSpec = 0;
+        expect(phantom.injectJs(script)).toEqual(true);
+        expect(window.scriptCacheSpec).toEqual(1);
+        expect(stats().hits).toEqual(before.hits + 1);
+
+        // same size and, most likely, same modification time
+        fs.write(script, "window.scriptCacheSpec = 2;", "w");
+        expect(phantom.injectJs(script)).toEqual(true);
+        expect(window.scriptCacheSpec).toEqual(2);
+        expect(stats().misses).toEqual(before.misses + 2);
+        expect(stats().hits).toEqual(before.hits + 1);
+        expect(stats().entries).toEqual(before.entries + 1);
+
+        fs.remove(script);
+    });
+
+    it("should report heap statistics and collect garbage on demand", function() {
+        var before, after, garbage = [];
+        for (var i = 0; i < 1000; ++i) {
+            garbage.push({ index: i });
+        }
+        garbage = null;
+
+        before = phantom.heapStatistics();
+        expect(before.size).toBeGreaterThan(0);
+        expect(before.capacity).toBeGreaterThan(0);
+        expect(before.objectCount).toBeGreaterThan(0);
+
+        phantom.gc();
+        after = phantom.heapStatistics();
+        expect(after.collectionCount).toBeGreaterThan(before.collectionCount);
+        expect(after.collectionTime >= before.collectionTime).toBeTruthy();
+    });
+
+    it("should collect an idle heap once, not at every interval", function() {
+        var settled;
+        runs(function() {
+            // Arms the idle collection, which must not arm itself again
+            phantom.gc();
+        });
+        waits(2500);
+        runs(function() {
+            settled = phantom.heapStatistics().collectionCount;
+        });
+        waits(4500);
+        runs(function() {
+            expect(phantom.heapStatistics().collectionCount - settled).toBeLessThan(2);
+        });
+    });
+});
+
+describe("phantom '--config' JSON parser", function() {
+    var fs = require('fs');
+    var execFile = require('child_process').execFile;
+    var phantomjs = require('system').executablePath;
+
+    // Runs "fixtures/print-config.js" once with each config file ({ name: json }),
+    // and collects the settings it prints and the error reported for the file
+    function runWithConfigs(configs) {
+        var results = {};
+        runs(function() {
+            Object.keys(configs).forEach(function (name, i) {
+                var file = 'temp-config-' + i + '.json';
+                fs.write(file, configs[name], 'w');
+                execFile(phantomjs, ['--config=' + file, 'fixtures/print-config.js'], function (code, stdout, stderr) {
+                    fs.remove(file);
+                    results[name] = {
+                        code: code,
+                        settings: stdout ? JSON.parse(stdout) : null,
+                        error: stderr.trim()
+                    };
+                });
+            });
+        });
+        waitsFor(function () {
+            return Object.keys(results).length === Object.keys(configs).length;
+        }, "phantomjs to run with each config", 30000);
+        return results;
+    }
+
+    it("should apply nested objects, numbers and escapes", function() {
+        var results = runWithConfigs({
+            good: '{ "diskCacheEnabled": true, "webSecurityEnabled": false, "maxConnectionsPerHost": 1.2e1,\n' +
+                  '  "hostConnections": { "a.test": 4, "b.test": 2E+0 }, "outputEncoding": "\\u006catin1",\n' +
+                  '  "notAnOption": [0, -0, 0.5, -1.25e-2, true, false, null, "q\\"b\\\\s\\/n\\nt\\tr\\rf\\fb\\b", {}] }'
+        });
+
+        runs(function() {
+            expect(results.good.error).toEqual("");
+            expect(results.good.code).toEqual(0);
+            expect(results.good.settings).toEqual({
+                diskCacheEnabled: true,
+                outputEncoding: "ISO-8859-1",
+                webSecurityEnabled: false,
+                maxConnectionsPerHost: 12,
+                hostConnections: { "a.test": 4, "b.test": 2 }
+            });
+        });
+    });
+
+    it("should reject malformed files and tell where", function() {
+        var errors = {
+            '{"diskCacheEnabled": true, \'a\': 1}': "Unexpected character ''' at line 1, column 28",
+            '{"a": 1,}': "Unexpected character '}' at line 1, column 9",
+            '{"a": [1,]}': "Unexpected character ']' at line 1, column 10",
+            '{"a": 01}': "Invalid number at line 1, column 8",
+            '{"a": -}': "Invalid number at line 1, column 8",
+            '{"a": 1.}': "Invalid number at line 1, column 9",
+            '{"a": +1}': "Unexpected character '+' at line 1, column 7",
+            '{"a": tru}': "Unexpected character 't' at line 1, column 7",
+            '{"a": "\\x"}': "Invalid escape at line 1, column 9",
+            '{"a": "\\u12G4"}': "Invalid \\u escape at line 1, column 9",
+            '{"a": "\n"}': "Control character in string at line 1, column 8",
+            '{\n  "a": 1\n  "b": 2\n}': "Unexpected character '\"' at line 3, column 3"
+        };
+        var configs = {};
+        Object.keys(errors).forEach(function (json) {
+            configs[json] = json;
+        });
+        var results = runWithConfigs(configs);
+
+        runs(function() {
+            Object.keys(errors).forEach(function (json) {
+                expect(results[json].error).toEqual("Config file MUST be in JSON format! " + errors[json]);
+                // Nothing of a rejected file is applied
+                expect(results[json].code).toEqual(0);
+                expect(results[json].settings.diskCacheEnabled).toEqual(false);
+            });
+        });
+    });
+});
+
+describe("phantom cookies indexed by domain", function() {
+    var names = function (cookies) {
+        return cookies.map(function (cookie) {
+            return cookie.name;
+        }).filter(function (name) {
+            return name.indexOf('indexed-') === 0;
+        }).sort();
+    };
+
+    // The cookies visible to a page coming from "url"
+    var page = require('webpage').create();
+    var cookiesAt = function (url) {
+        page.setContent('<html><body></body></html>', url);
+        return names(page.cookies);
+    };
+
+    afterEach(function() {
+        ['indexed-parent', 'indexed-host', 'indexed-other', 'indexed-tld', 'indexed-suffix'].forEach(function (name) {
+            phantom.deleteCookie(name);
+        });
+    });
+
+    it("should reject cookies set for a public suffix", function() {
+        expect(phantom.addCookie({ name: 'indexed-tld', value: '1', domain: '.com' })).toBeFalsy();
+        expect(phantom.addCookie({ name: 'indexed-suffix', value: '1', domain: '.co.uk' })).toBeFalsy();
+        expect(names(phantom.cookies)).toEqual([]);
+    });
+
+    it("should send a parent domain cookie to all of its subdomains only", function() {
+        expect(phantom.addCookie({ name: 'indexed-parent', value: '1', domain: '.example.test', path: '/' })).toBeTruthy();
+        expect(phantom.addCookie({ name: 'indexed-host', value: '2', domain: 'www.example.test', path: '/docs' })).toBeTruthy();
+        expect(phantom.addCookie({ name: 'indexed-other', value: '3', domain: '.other.test', path: '/' })).toBeTruthy();
+        expect(names(phantom.cookies)).toEqual(['indexed-host', 'indexed-other', 'indexed-parent']);
+
+        expect(cookiesAt('http://example.test/')).toEqual(['indexed-parent']);
+        expect(cookiesAt('http://sub.example.test/')).toEqual(['indexed-parent']);
+        expect(cookiesAt('http://a.b.example.test/index.html')).toEqual(['indexed-parent']);
+        expect(cookiesAt('http://www.example.test/')).toEqual(['indexed-parent']);
+        expect(cookiesAt('http://www.example.test/docs/page.html')).toEqual(['indexed-host', 'indexed-parent']);
+        expect(cookiesAt('http://other.test/')).toEqual(['indexed-other']);
+
+        // WebKit itself gets them from the same index
+        page.setContent('<html><body></body></html>', 'http://sub.example.test/');
+        expect(page.evaluate(function () {
+            return document.cookie;
+        })).toEqual('indexed-parent=1');
+    });
+
+    it("should not send a domain cookie to look-alike domains", function() {
+        expect(phantom.addCookie({ name: 'indexed-parent', value: '1', domain: '.example.test', path: '/' })).toBeTruthy();
+
+        expect(cookiesAt('http://notexample.test/')).toEqual([]);
+        expect(cookiesAt('http://example.test.other/')).toEqual([]);
+        expect(cookiesAt('http://example.com/')).toEqual([]);
+        page.close();
+    });
+});
+
+describe("phantom connections", function() {
+    var server = require('webserver').create();
+    var secureServer = require('webserver').create();
+    var execFile = require('child_process').execFile;
+    var phantomjs = require('system').executablePath;
+
+    var respond = function (request, response) {
+        // A known length keeps the connection alive for the second page
+        response.statusCode = 200;
+        response.headers = { 'Content-Type': 'text/html', 'Content-Length': '7' };
+        response.write('<p></p>');
+        response.close();
+    };
+
+    // Runs "fixtures/connection-timings.js" against "url" with the given options,
+    // and returns the connection timings of the two pages it opens
+    function timingsOf(url, options) {
+        var result = {};
+        runs(function() {
+            execFile(phantomjs, options.concat(['fixtures/connection-timings.js', url]), function (code, stdout, stderr) {
+                result.code = code;
+                result.error = stderr.trim();
+                result.timings = stdout ? JSON.parse(stdout) : null;
+            });
+        });
+        waitsFor(function () {
+            return result.hasOwnProperty('code');
+        }, "phantomjs to open both pages", 30000);
+        return result;
+    }
+
+    it("should start a HTTP and a HTTPS server", function() {
+        expect(server.listen(12347, { keepAlive: true }, respond)).toBeTruthy();
+        expect(secureServer.listen(12348, { keepAlive: true, sslCertificate: 'fixtures/localhost.pem' }, respond)).toBeTruthy();
+    });
+
+    it("should resume the SSL session of the previous connection", function() {
+        var result = timingsOf('https://localhost:12348/', ['--cert-authorities-path=fixtures/tls-ca']);
+
+        runs(function() {
+            expect(result.error).toEqual("");
+            expect(result.code).toEqual(0);
+            expect(result.timings.length).toEqual(2);
+            expect(result.timings[0].ssl).not.toBeLessThan(0);
+            expect(result.timings[0].sslResumed).toEqual(false);
+            expect(result.timings[1].ssl).not.toBeLessThan(0);
+            expect(result.timings[1].sslResumed).toEqual(true);
+        });
+    });
+
+    it("should not resume SSL sessions when resumption is disabled", function() {
+        var result = timingsOf('https://localhost:12348/', ['--cert-authorities-path=fixtures/tls-ca', '--ssl-session-resumption=no']);
+
+        runs(function() {
+            expect(result.code).toEqual(0);
+            expect(result.timings.length).toEqual(2);
+            expect(result.timings[0].sslResumed).toEqual(false);
+            expect(result.timings[1].sslResumed).toEqual(false);
+        });
+    });
+
+    it("should give each page its own connections by default", function() {
+        var result = timingsOf('http://localhost:12347/', []);
+
+        runs(function() {
+            expect(result.code).toEqual(0);
+            expect(result.timings.length).toEqual(2);
+            expect(result.timings[0].connect).not.toBeLessThan(0);
+            expect(result.timings[1].connect).not.toBeLessThan(0);
+        });
+    });
+
+    it("should reuse the connection of another page when shared", function() {
+        var result = timingsOf('http://localhost:12347/', ['--shared-connections=yes']);
+
+        runs(function() {
+            expect(result.code).toEqual(0);
+            expect(result.timings.length).toEqual(2);
+            expect(result.timings[0].connect).not.toBeLessThan(0);
+            expect(result.timings[1].connect).toEqual(-1);
+        });
+    });
+
+    it("should stop the servers", function() {
+        server.close();
+        secureServer.close();
+        expect(server.port).toEqual("");
+        expect(secureServer.port).toEqual("");
+    });
+});
+
+describe("phantom host name cache", function() {
+    var fs = require('fs');
+    var server = require('webserver').create();
+    var execFile = require('child_process').execFile;
+    var phantomjs = require('system').executablePath;
+    // Reserved name that never resolves: only a restored entry can make it reachable
+    var host = 'snapshot-host.test';
+
+    // Big-endian integers and strings, as QDataStream writes them
+    function uint32(n) {
+        return String.fromCharCode((n >>> 24) & 255, (n >>> 16) & 255, (n >>> 8) & 255, n & 255);
+    }
+    function int64(n) {
+        return uint32(Math.floor(n / 4294967296)) + uint32(n % 4294967296);
+    }
+    function qstring(s) {
+        var data = uint32(s.length * 2);
+        for (var i = 0; i < s.length; i++) {
+            data += String.fromCharCode(0, s.charCodeAt(i));
+        }
+        return data;
+    }
+
+    // A snapshot of the cache as QtNetwork writes it (see QHostInfoCache::snapshot()):
+    // the version, the time it was taken and { name, age, addresses } entries, here
+    // for "names" that resolve to 127.0.0.1 and were looked up "age" ms earlier
+    function snapshot(names, age, takenAt) {
+        var data = uint32(1) + int64(takenAt) + uint32(names.length);
+        names.forEach(function (name) {
+            data += qstring(name) + int64(age);
+            // One address: QAbstractSocket::IPv4Protocol, 127.0.0.1
+            data += uint32(1) + String.fromCharCode(0) + uint32(0x7f000001);
+        });
+        return data;
+    }
+
+    // Whether the snapshot in "file" holds an entry for "name"
+    function snapshotHolds(file, name) {
+        return fs.read(file, 'b').indexOf(qstring(name)) !== -1;
+    }
+
+    // Runs "script" with "args" and the options, and returns its exit code and output
+    function run(options, script, args) {
+        var result = {};
+        runs(function() {
+            execFile(phantomjs, options.concat([script]).concat(args), function (code, stdout, stderr) {
+                result.code = code;
+                result.stdout = stdout.trim();
+            });
+        });
+        waitsFor(function () {
+            return result.hasOwnProperty('code');
+        }, "phantomjs to exit", 30000);
+        return result;
+    }
+
+    it("should start a server", function() {
+        expect(server.listen(12349, function (request, response) {
+            // "never.js" is left pending: the page that loads it stays blocked
+            if (request.url !== '/never.js') {
+                response.statusCode = 200;
+                response.write('<p></p>');
+                response.close();
+            }
+        })).toBeTruthy();
+    });
+
+    it("should resolve host names from a restored snapshot", function() {
+        var result;
+        runs(function() {
+            fs.write('temp-hosts.snapshot', snapshot([host], 0, Date.now()), 'wb');
+        });
+        result = run(['--dns-cache-file=temp-hosts.snapshot'], 'fixtures/open-twice.js', ['http://' + host + ':12349/', '0']);
+
+        runs(function() {
+            expect(result.code).toEqual(0);
+            expect(JSON.parse(result.stdout)).toEqual(['success', 'success']);
+            // Saved back on exit
+            expect(snapshotHolds('temp-hosts.snapshot', host)).toBeTruthy();
+            fs.remove('temp-hosts.snapshot');
+        });
+    });
+
+    it("should expire restored entries with the age they had in the snapshot", function() {
+        var stale, expiring;
+        runs(function() {
+            // Looked up 2 minutes ago: past the default 60 s, never restored
+            fs.write('temp-stale.snapshot', snapshot([host], 0, Date.now() - 120000), 'wb');
+            // Just looked up, with a TTL of 4 s: expires while the script waits
+            fs.write('temp-expiring.snapshot', snapshot([host], 0, Date.now()), 'wb');
+        });
+        stale = run(['--dns-cache-file=temp-stale.snapshot'], 'fixtures/open-twice.js', ['http://' + host + ':12349/', '0']);
+        expiring = run(['--dns-cache-file=temp-expiring.snapshot', '--dns-cache-ttl=4'], 'fixtures/open-twice.js', ['http://' + host + ':12349/', '5000']);
+
+        runs(function() {
+            expect(JSON.parse(stale.stdout)).toEqual(['fail', 'fail']);
+            expect(JSON.parse(expiring.stdout)).toEqual(['success', 'fail']);
+            fs.remove('temp-stale.snapshot');
+            fs.remove('temp-expiring.snapshot');
+        });
+    });
+
+    it("should resolve the hosts the preload scanner finds only with DNS prefetch", function() {
+        var prefetched, notPrefetched;
+        // The image host is only ever seen by the preload scanner, while the parser waits
+        // for "never.js"; the snapshot saved on exit tells whether it was resolved
+        prefetched = run(['--dns-prefetch=yes', '--dns-cache-file=temp-prefetch.snapshot'], 'fixtures/preload-scan.js', ['12349']);
+        notPrefetched = run(['--dns-prefetch=no', '--dns-cache-file=temp-no-prefetch.snapshot'], 'fixtures/preload-scan.js', ['12349']);
+
+        runs(function() {
+            expect(prefetched.code).toEqual(0);
+            expect(notPrefetched.code).toEqual(0);
+            expect(snapshotHolds('temp-prefetch.snapshot', 'localhost')).toBeTruthy();
+            expect(snapshotHolds('temp-no-prefetch.snapshot', 'localhost')).toBeFalsy();
+            fs.remove('temp-prefetch.snapshot');
+            fs.remove('temp-no-prefetch.snapshot');
+        });
+    });
+
+    it("should stop the server", function() {
+        server.close();
+        expect(server.port).toEqual("");
+    });
 });
@@ -1,3 +1,35 @@
+// Decodes the base64 images ({ name: { format: ..., data: ... } }) in the "decoder" page,
+// and samples the color of each of the "points" ({ name: [x, y] }) in them
+function decodeImages(decoder, images, points) {
+    decoder.evaluate(function (images, points) {
+        window.decoded = {};
+        Object.keys(images).forEach(function (name) {
+            var img = new Image();
+            img.onload = function () {
+                var canvas = document.createElement('canvas');
+                canvas.width = img.width;
+                canvas.height = img.height;
+                var context = canvas.getContext('2d');
+                context.drawImage(img, 0, 0);
+                var result = { width: img.width, height: img.height, pixels: {} };
+                Object.keys(points).forEach(function (point) {
+                    var data = context.getImageData(points[point][0], points[point][1], 1, 1).data;
+                    result.pixels[point] = Array.prototype.slice.call(data, 0, 3);
+                });
+                window.decoded[name] = result;
+            };
+            img.src = 'data:image/' + images[name].format + ';base64,' + images[name].data;
+        });
+    }, images, points);
+}
+
+// The images decoded by decodeImages(), or null until "count" of them are
+function decodedImages(decoder, count) {
+    return decoder.evaluate(function (count) {
+        return Object.keys(window.decoded).length === count ? window.decoded : null;
+    }, count);
+}
+
 function checkClipRect(page, clipRect) {
     expectHasProperty(page, 'clipRect');
     it("should have clipRect with height "+clipRect.height, function () {
@@ -132,11 +164,25 @@ describe("WebPage object", function() {
         expect(page.settings).toNotEqual({});
     });
 
+    it("should have connection settings with the default values", function() {
+        expect(page.settings.maxConnectionsPerHost).toEqual(6);
+        expect(page.settings.hostConnections).toEqual({});
+        expect(page.settings.httpPipelining).toEqual(false);
+        expect(page.settings.httpPipelineLength).toEqual(3);
+        expect(page.settings.resourceTimeout).toEqual(0);
+        expect(page.settings.hostResourceTimeouts).toEqual({});
+    });
+
     expectHasProperty(page, 'customHeaders');
     it("should have customHeaders as an empty object", function() {
             expect(page.customHeaders).toEqual({});
     });
 
+    expectHasProperty(page, 'resourceEventFields');
+    it("should report all the resource event fields by default", function() {
+            expect(page.resourceEventFields).toEqual([]);
+    });
+
     expectHasProperty(page, 'zoomFactor');
     it("should have zoomFactor of 1", function() {
             expect(page.zoomFactor).toEqual(1.0);
@@ -599,6 +645,475 @@ describe("WebPage object", function() {
 
     });
 
+    it("should report monotonic timestamps and phase timings of resources", function() {
+        var server = require('webserver').create();
+        server.listen(12345, function(request, response) {
+            response.write("timings");
+            response.close();
+        });
+
+        var requested, received;
+        page.onResourceRequested = function(request) {
+            requested = requested || request;
+        };
+        page.onResourceReceived = function(response) {
+            if (response.stage === "end") {
+                received = received || response;
+            }
+        };
+
+        var handled = false;
+        runs(function() {
+            page.open("http://localhost:12345/timings.txt", function (status) {
+                expect(status == 'success').toEqual(true);
+                handled = true;
+            });
+        });
+
+        waits(50);
+
+        runs(function() {
+            expect(handled).toEqual(true);
+            expect(typeof requested.timestamp).toEqual("number");
+            expect(received.timestamp).not.toBeLessThan(requested.timestamp);
+            expect(typeof received.timings).toEqual("object");
+            expect(received.timings.wait).not.toBeLessThan(0);
+            expect(received.timings.receive).not.toBeLessThan(0);
+            page.onResourceRequested = null;
+            page.onResourceReceived = null;
+            server.close();
+        });
+    });
+
+    it("should only report the resource event fields that were asked for", function() {
+        var server = require('webserver').create();
+        server.listen(12345, function(request, response) {
+            response.write("fields");
+            response.close();
+        });
+
+        var received;
+        page.resourceEventFields = ["url", "status"];
+        page.onResourceReceived = function(response) {
+            if (response.stage === "end") {
+                received = received || response;
+            }
+        };
+
+        var handled = false;
+        runs(function() {
+            page.open("http://localhost:12345/fields.txt", function (status) {
+                expect(status == 'success').toEqual(true);
+                handled = true;
+            });
+        });
+
+        waits(50);
+
+        runs(function() {
+            expect(handled).toEqual(true);
+            expect(typeof received.id).toEqual("number");
+            expect(received.url).toEqual("http://localhost:12345/fields.txt");
+            expect(received.status).toEqual(200);
+            expect(received.headers).toBeUndefined();
+            expect(received.time).toBeUndefined();
+            page.resourceEventFields = [];
+            page.onResourceReceived = null;
+            server.close();
+        });
+    });
+
+    it("should fail blocked requests without sending them", function() {
+        var server = require('webserver').create();
+        var requested = [];
+        server.listen(12345, function(request, response) {
+            requested.push(request.url);
+            response.write("<html><body><img src='/ads/banner.png'><img src='/logo.png'></body></html>");
+            response.close();
+        });
+
+        page.blockedUrls = ["! comment", "http://localhost:12345/ads/", "*.woff"];
+        expect(page.blockedUrls).toEqual(["http://localhost:12345/ads/", "*.woff"]);
+
+        var handled = false, seen = [], received = [];
+        page.onResourceRequested = function(request) {
+            seen.push(request.url);
+        };
+        page.onResourceReceived = function(response) {
+            received.push(response.url);
+        };
+        runs(function() {
+            page.open("http://localhost:12345/blocklist.html", function (status) {
+                expect(status == 'success').toEqual(true);
+                handled = true;
+            });
+        });
+
+        // The load completes once every image has either loaded or failed
+        waitsFor(function () {
+            return handled;
+        }, "the page to load", 3000);
+
+        runs(function() {
+            expect(requested).toNotContain("/ads/banner.png");
+            expect(requested).toContain("/logo.png");
+            expect(seen).toNotContain("http://localhost:12345/ads/banner.png");
+            expect(received).toContain("http://localhost:12345/logo.png");
+            expect(received).toNotContain("http://localhost:12345/ads/banner.png");
+            page.blockedUrls = [];
+            page.onResourceRequested = null;
+            page.onResourceReceived = null;
+            server.close();
+        });
+    });
+
+    it("should abort resources past their timeout", function() {
+        var server = require('webserver').create();
+        var hung = null;
+        server.listen(12345, function(request, response) {
+            if (request.url === "/hung.png") {
+                hung = response;
+                return;
+            }
+            response.write("<html><body><img src='/hung.png'></body></html>");
+            response.close();
+        });
+
+        var p = require('webpage').create();
+        var status = null, stages = [];
+        p.settings.resourceTimeout = 5000;
+        p.settings.hostResourceTimeouts = { "localhost": 200 };
+        p.onResourceReceived = function(response) {
+            if (response.url === "http://localhost:12345/hung.png") {
+                stages.push(response.stage);
+                if (response.stage === "timeout") {
+                    expect(response.timeout).toEqual(200);
+                }
+            }
+        };
+        runs(function() {
+            p.open("http://localhost:12345/timeout.html", function (s) {
+                status = s;
+            });
+        });
+
+        waitsFor(function() {
+            return status !== null;
+        }, "the page to load despite the hung resource", 3000);
+
+        runs(function() {
+            expect(status).toEqual("success");
+            expect(stages[0]).toEqual("timeout");
+            expect(stages).toContain("end");
+            if (hung) {
+                hung.close();
+            }
+            p.close();
+            server.close();
+        });
+    });
+
+    it("should report network activity and fire onNetworkIdle", function() {
+        var server = require('webserver').create();
+        server.listen(12345, function(request, response) {
+            response.write("<html><body><img src='/one.png'><img src='/two.png'></body></html>");
+            response.close();
+        });
+
+        var idle = null, before = page.networkActivity.requested;
+        expect(typeof page.networkActivity.inflight).toEqual("number");
+        page.onNetworkIdle = function(quietMs, maxInflight) {
+            idle = [quietMs, maxInflight, page.networkActivity.inflight];
+        };
+        runs(function() {
+            page.waitForNetworkIdle(50, 0);
+            page.open("http://localhost:12345/idle.html", function (status) {});
+        });
+
+        waitsFor(function() {
+            return idle !== null;
+        }, "network to be idle", 3000);
+
+        runs(function() {
+            expect(idle).toEqual([50, 0, 0]);
+            expect(page.networkActivity.requested - before).toBeGreaterThan(2);
+            page.onNetworkIdle = null;
+            server.close();
+        });
+    });
+
+    it("should block URLs by each form of blocklist rule", function() {
+        var p = require('webpage').create();
+        var blocked = [
+            "http://tracker.test/a.png", "http://x.tracker.test/a.png",
+            "http://ads.test/a.png", "http://www.ads.test/a.png",
+            "http://cdn.test/a.png",
+            "http://static.test/ads/a.png",
+            "http://static.test/track?id=5",
+            "http://fonts.test/font.woff",
+            "http://fonts.test/a.png?utm_source=mail",
+            "http://assets.test/banners/a.png", "https://assets.test/banners/b.png",
+            "http://assets.test:8080/a.png"
+        ];
+        var allowed = [
+            "http://notcdn.test/a.png",
+            "http://static.test/img/a.png",
+            "http://static.test/trackXid=5.png",
+            "http://fonts.test/a_utm_source=mail.png",
+            "http://assets.test/logo.png",
+            "http://assets.test:8081/a.png"
+        ];
+        var requested = [], received = [];
+        p.blockedUrls = [
+            "||tracker.test",
+            ".ads.test",
+            "cdn.test",
+            "http://static.test/ads/",
+            "http://static.test/track?id=*",
+            "*.woff",
+            "*?utm_source=*",
+            "assets.test/banners",
+            "assets.test:8080"
+        ];
+        p.onResourceRequested = function(request) {
+            requested.push(request.url);
+        };
+        p.onResourceReceived = function(response) {
+            received.push(response.url);
+        };
+        runs(function() {
+            p.content = '<html><body><script>window.failed = [];</script>' +
+                blocked.concat(allowed).map(function(url) {
+                    return '<img src="' + url + '" onerror="window.failed.push(this.src)">';
+                }).join('') + '</body></html>';
+        });
+
+        // Blocked images fail as soon as their reply finishes
+        waitsFor(function () {
+            var failed = p.evaluate(function () {
+                return window.failed || [];
+            });
+            return blocked.every(function (url) {
+                return failed.indexOf(url) !== -1;
+            });
+        }, "the blocked images to fail", 3000);
+
+        runs(function() {
+            blocked.forEach(function(url) {
+                expect(requested).toNotContain(url);
+                expect(received).toNotContain(url);
+            });
+            allowed.forEach(function(url) {
+                expect(requested).toContain(url);
+            });
+            p.close();
+        });
+    });
+
+    it("should pass structured arguments to evaluated functions", function() {
+        page.content = '<html><body></body></html>';
+        var inspect = function(n, s, list, map, missing) {
+            return [typeof n, n + 1, s, Array.isArray(list), list.length, list[1].x, map.nested.flag, typeof missing];
+        };
+        var i, result;
+        for (i = 0; i < 3; i++) {
+            result = page.evaluate(inspect, 41, "text", [1, { x: "y" }], { nested: { flag: true } }, undefined);
+            expect(result).toEqual(["number", 42, "text", true, 2, "y", true, "undefined"]);
+        }
+        // Values the bridge does not carry unchanged still go through JSON
+        expect(page.evaluate(function(a) { return a.value === null; }, { value: null })).toEqual(true);
+    });
+
+    it("should pass objects and arrays to evaluated functions as JSON", function() {
+        page.content = '<html><body></body></html>';
+        var describe = function(map, list) {
+            return Object.keys(map).join(",") + " " + JSON.stringify(map) + " " + JSON.stringify(list);
+        };
+        expect(page.evaluate(describe, { z: 1, a: Infinity, m: -Infinity }, [Infinity, 2]))
+            .toEqual('z,a,m {"z":1,"a":null,"m":null} [null,2]');
+        expect(page.evaluateBulk(describe, { b: 2, a: 1 }, [])).toEqual('b,a {"b":2,"a":1} []');
+    });
+
+    it("should compile an evaluated function once and call it again", function() {
+        page.content = '<html><body></body></html>';
+        // State kept on the function object only survives if the page reuses it
+        var count = function(arg) {
+            var self = arguments.callee;
+            self.calls = (self.calls || 0) + 1;
+            return self.calls;
+        };
+        expect(page.evaluate(count, 1)).toEqual(1);
+        expect(page.evaluate(count, 2)).toEqual(2);
+        expect(page.evaluate(count, "three")).toEqual(3);
+
+        var countObjects = function(arg) {
+            var self = arguments.callee;
+            self.calls = (self.calls || 0) + 1;
+            return self.calls + ":" + arg.n;
+        };
+        expect(page.evaluate(countObjects, { n: 1 })).toEqual("1:1");
+        expect(page.evaluate(countObjects, { n: 2 })).toEqual("2:2");
+
+        // A new document starts from a fresh compiled function
+        page.content = '<html><body></body></html>';
+        expect(page.evaluate(count, 1)).toEqual(1);
+    });
+
+    it("should pick the overload matching the arguments on every call", function() {
+        var p = require('webpage').create();
+        p.content = '<html><body><iframe name="1"></iframe><iframe name="other"></iframe></body></html>';
+        var i;
+        for (i = 0; i < 3; i++) {
+            // switchToFrame(int) goes by position, switchToFrame(QString) by name
+            expect(p.switchToFrame(1)).toBeTruthy();
+            expect(p.frameName).toEqual("other");
+            p.switchToMainFrame();
+            expect(p.switchToFrame("1")).toBeTruthy();
+            expect(p.frameName).toEqual("1");
+            p.switchToMainFrame();
+        }
+        p.close();
+    });
+
+    it("should transfer large results in bulk", function() {
+        page.content = '<html><body><a href="#a">A</a><a href="#b">B</a></body></html>';
+        var numbers = page.evaluateBulk(function(n) {
+            var list = [], i;
+            for (i = 0; i < n; i++) {
+                list.push(i / 2);
+            }
+            return list;
+        }, 100000);
+        expect(Array.isArray(numbers)).toEqual(true);
+        expect(numbers.length).toEqual(100000);
+        expect(numbers[0]).toEqual(0);
+        expect(numbers[99999]).toEqual(49999.5);
+
+        var links = page.evaluateBulk(function(prefix) {
+            return Array.prototype.map.call(document.querySelectorAll('a'), function(a) {
+                return { text: prefix + a.textContent, hash: a.hash, when: new Date(0), sizes: [1, 2, 3, 4, 5, 6, 7, 8] };
+            });
+        }, "link ");
+        expect(links.length).toEqual(2);
+        expect(links[1].text).toEqual("link B");
+        expect(links[0].hash).toEqual("#a");
+        expect(links[0].when instanceof Date).toEqual(true);
+        expect(links[0].sizes[7]).toEqual(8);
+        expect(page.evaluateBulk(function(v) { return v; }, null)).toEqual(null);
+    });
+
+    it("should render a clip within the viewport at the current layout", function() {
+        var decoder = require('webpage').create();
+        var rendered;
+        runs(function() {
+            expect(page.renderAtCurrentLayout).toEqual(false);
+            page.viewportSize = { width: 100, height: 100 };
+            // The red band follows the viewport height: a relayout at the size of the
+            // contents would make it cover the whole clip
+            page.content = '<html><body style="margin:0">' +
+                '<div style="height:50vh;background:#f00"></div><div style="height:2000px;background:#0f0"></div>' +
+                '<script>window.resizes = []; window.addEventListener("resize", function () { window.resizes.push(window.innerHeight); });</script>' +
+                '</body></html>';
+            page.clipRect = { top: 0, left: 0, width: 50, height: 100 };
+            page.renderAtCurrentLayout = true;
+            rendered = page.renderBase64('png');
+            // Fires after any resize event the render queued
+            page.evaluate(function() { setTimeout(function() { window.settled = true; }, 0); });
+        });
+
+        waitsFor(function () {
+            return page.evaluate(function() { return window.settled === true; });
+        }, "the page to handle its pending events", 3000);
+
+        runs(function() {
+            expect(page.evaluate(function() { return window.resizes; })).toEqual([]);
+            expect(page.evaluate(function() { return window.innerHeight; })).toEqual(100);
+            expect(page.viewportSize).toEqual({ width: 100, height: 100 });
+            decodeImages(decoder, { current: { format: 'png', data: rendered } }, { band: [10, 25], below: [10, 75] });
+        });
+
+        waitsFor(function () {
+            return decodedImages(decoder, 1) !== null;
+        }, "the render to be decoded", 3000);
+
+        runs(function() {
+            var current = decodedImages(decoder, 1).current;
+            expect(current.width).toEqual(50);
+            expect(current.height).toEqual(100);
+            expect(current.pixels.band).toEqual([255, 0, 0]);
+            expect(current.pixels.below).toEqual([0, 255, 0]);
+            decoder.close();
+
+            // Without the option, the same render lays the page out again: the probe notices
+            page.renderAtCurrentLayout = false;
+            page.renderBase64('png');
+        });
+
+        waitsFor(function () {
+            return page.evaluate(function() { return window.resizes.length > 0; });
+        }, "the resize event of a render at the size of the contents", 3000);
+
+        runs(function() {
+            page.clipRect = { top: 0, left: 0, width: 0, height: 0 };
+        });
+    });
+
+    it("should render only the damaged areas since the previous capture", function() {
+        var first, second, damage;
+        runs(function() {
+            page.viewportSize = { width: 200, height: 200 };
+            page.content = '<html><body style="margin:0"><div id="clock" style="position:absolute;left:10px;top:20px;width:30px;height:10px"></div></body></html>';
+            first = page.renderDamage('png');
+            second = page.renderDamage('png');
+            page.evaluate(function() { document.getElementById('clock').style.background = 'red'; });
+        });
+
+        // Each capture takes the damage: poll until the repaint shows up
+        waitsFor(function () {
+            damage = page.renderDamage('png');
+            return damage.length > 0;
+        }, "the repaint to be reported as damage", 3000);
+
+        runs(function() {
+            var bounds = { left: 200, top: 200, right: 0, bottom: 0 };
+            damage.forEach(function (rect) {
+                expect(rect.data.length).toBeGreaterThan(0);
+                bounds.left = Math.min(bounds.left, rect.left);
+                bounds.top = Math.min(bounds.top, rect.top);
+                bounds.right = Math.max(bounds.right, rect.left + rect.width);
+                bounds.bottom = Math.max(bounds.bottom, rect.top + rect.height);
+            });
+            expect(first.length).toEqual(1);
+            expect(first[0].width).toEqual(200);
+            expect(first[0].data.length).toBeGreaterThan(0);
+            expect(second.length).toEqual(0);
+            // The damage covers the 30x10 box at (10, 20), and little else
+            expect(bounds.left).not.toBeGreaterThan(10);
+            expect(bounds.top).not.toBeGreaterThan(20);
+            expect(bounds.right).not.toBeLessThan(40);
+            expect(bounds.bottom).not.toBeLessThan(30);
+            expect(bounds.left).not.toBeLessThan(0);
+            expect(bounds.top).not.toBeLessThan(0);
+            expect(bounds.right).not.toBeGreaterThan(50);
+            expect(bounds.bottom).not.toBeGreaterThan(40);
+        });
+    });
+
+    it("should record an animated GIF frame by frame", function() {
+        var fs = require('fs');
+        var file = "temp-webpage-animation.gif";
+        page.viewportSize = { width: 64, height: 48 };
+        page.content = '<html><body style="margin:0;background:red"></body></html>';
+        expect(page.renderGifFrame(file, 50)).toEqual(true);
+        page.evaluate(function() { document.body.style.background = 'blue'; });
+        expect(page.renderGifFrame(file, 50)).toEqual(true);
+        expect(page.renderGifFrame(file, 200)).toEqual(true);
+        expect(page.finishGif()).toEqual(3);
+        expect(page.finishGif()).toEqual(0);
+        expect(fs.read(file).substring(0, 6)).toEqual("GIF89a");
+        fs.remove(file);
+    });
+
     it("should set valid cookie properly, then remove it", function() {
         var server = require('webserver').create();
         server.listen(12345, function(request, response) {
@@ -850,6 +1365,169 @@ describe("WebPage object", function() {
             expect(message).toEqual("PASS");
         });
     });
+
+    it("should set the page content and location", function() {
+        page.setContent('<html><body><div>Test div</div><a href="next.html">next</a></body></html>',
+                        'http://www.example.test/docs/');
+        expect(page.url).toEqual('http://www.example.test/docs/');
+        expect(page.evaluate(function () {
+            return [document.querySelector('div').textContent, window.location.href, document.querySelector('a').href];
+        })).toEqual(['Test div', 'http://www.example.test/docs/', 'http://www.example.test/docs/next.html']);
+    });
+
+    it("should render a page as base64 encoded PNG and JPEG", function() {
+        var decoder = require('webpage').create();
+        var images = {};
+
+        runs(function() {
+            page.viewportSize = { width: 300, height: 200 };
+            page.content = '<html><body style="margin:0;background:#f00;height:5000px">' +
+                '<div style="height:100px;background:#00f"></div></body></html>';
+
+            images.png = { format: 'png', data: page.renderBase64('png') };
+            expect(images.png.data.indexOf('iVBORw0KGgo')).toEqual(0);
+            images.jpeg = { format: 'jpeg', data: page.renderBase64('jpg') };
+            expect(images.jpeg.data.indexOf('/9j/')).toEqual(0);
+            expect(page.renderBase64('unknown-format')).toEqual('');
+
+            // Decode both images and sample a pixel in each colored area
+            decodeImages(decoder, images, { top: [150, 50], bottom: [150, 4000] });
+        });
+
+        waitsFor(function () {
+            return decodedImages(decoder, 2) !== null;
+        }, "both images to be decoded", 3000);
+
+        runs(function() {
+            var decoded = decodedImages(decoder, 2);
+            ['png', 'jpeg'].forEach(function (format) {
+                var image = decoded[format];
+                expect(image.width).toEqual(300);
+                expect(image.height).toEqual(5000);
+                // JPEG is lossy, so only the dominant channel is checked
+                expect(image.pixels.top[0]).toBeLessThan(30);
+                expect(image.pixels.top[2]).toBeGreaterThan(225);
+                expect(image.pixels.bottom[0]).toBeGreaterThan(225);
+                expect(image.pixels.bottom[2]).toBeLessThan(30);
+            });
+            decoder.close();
+        });
+    });
+
+    it("should render a tall page to PNG and JPEG files one strip at a time", function() {
+        var fs = require('fs');
+        var decoder = require('webpage').create();
+        var images = {};
+
+        runs(function() {
+            // Strips are 4096 pixels high: the green band crosses the first boundary
+            page.viewportSize = { width: 200, height: 200 };
+            page.content = '<html><body style="margin:0;background:#f00;height:20000px">' +
+                '<div style="height:100px;background:#00f"></div>' +
+                '<div style="position:absolute;top:4000px;width:100%;height:200px;background:#0f0"></div>' +
+                '</body></html>';
+
+            ['png', 'jpg'].forEach(function (format) {
+                var file = 'temp-webpage-tall.' + format;
+                expect(page.render(file)).toEqual(true);
+                images[format] = { format: format === 'jpg' ? 'jpeg' : format, data: btoa(fs.read(file, 'b')) };
+                fs.remove(file);
+            });
+
+            decodeImages(decoder, images, {
+                top: [100, 50],
+                beforeBoundary: [100, 4095],
+                afterBoundary: [100, 4096],
+                bottom: [100, 19990]
+            });
+        });
+
+        waitsFor(function () {
+            return decodedImages(decoder, 2) !== null;
+        }, "both images to be decoded", 5000);
+
+        runs(function() {
+            var decoded = decodedImages(decoder, 2);
+            ['png', 'jpg'].forEach(function (format) {
+                var image = decoded[format];
+                expect(image.width).toEqual(200);
+                expect(image.height).toEqual(20000);
+                expect(image.pixels.top[2]).toBeGreaterThan(225);
+                expect(image.pixels.top[0]).toBeLessThan(30);
+                [image.pixels.beforeBoundary, image.pixels.afterBoundary].forEach(function (pixel) {
+                    expect(pixel[1]).toBeGreaterThan(225);
+                    expect(pixel[0]).toBeLessThan(30);
+                });
+                expect(image.pixels.bottom[0]).toBeGreaterThan(225);
+                expect(image.pixels.bottom[1]).toBeLessThan(30);
+            });
+            decoder.close();
+        });
+    });
+
+    it("should render the same pixels tile by tile as in one tile", function() {
+        var decoders = {};
+        // Around the first tile boundary (x = 4096) of the whole render, and their
+        // coordinates in the parts that each fit in one tile
+        var points = { red: [4092, 150], greenBefore: [4095, 150], greenAfter: [4096, 150], blue: [4100, 150], corner: [4990, 299] };
+        var parts = { left: {}, right: {} };
+        Object.keys(points).forEach(function (name) {
+            var x = points[name][0], y = points[name][1];
+            if (x < 4096) {
+                parts.left[name] = [x, y];
+            } else {
+                parts.right[name] = [x - 4096, y];
+            }
+        });
+
+        runs(function() {
+            var clips = {
+                whole: { left: 0, top: 0, width: 0, height: 0 },
+                left: { left: 0, top: 0, width: 4096, height: 300 },
+                right: { left: 4096, top: 0, width: 904, height: 300 }
+            };
+            page.viewportSize = { width: 400, height: 300 };
+            page.content = '<html><body style="margin:0;width:5000px;height:300px;background:#00f">' +
+                '<div style="position:absolute;left:0;top:0;width:4094px;height:300px;background:#f00"></div>' +
+                '<div style="position:absolute;left:4094px;top:0;width:4px;height:300px;background:#0f0"></div>' +
+                '</body></html>';
+
+            Object.keys(clips).forEach(function (name) {
+                page.clipRect = clips[name];
+                decoders[name] = require('webpage').create();
+                decodeImages(decoders[name], { image: { format: 'png', data: page.renderBase64('png') } },
+                             name === 'whole' ? points : parts[name]);
+            });
+            page.clipRect = clips.whole;
+        });
+
+        waitsFor(function () {
+            return Object.keys(decoders).every(function (name) {
+                return decodedImages(decoders[name], 1) !== null;
+            });
+        }, "the renders to be decoded", 5000);
+
+        runs(function() {
+            var whole = decodedImages(decoders.whole, 1).image;
+            var left = decodedImages(decoders.left, 1).image;
+            var right = decodedImages(decoders.right, 1).image;
+            expect(whole.width).toEqual(5000);
+            expect(whole.height).toEqual(300);
+            expect(whole.pixels.red).toEqual([255, 0, 0]);
+            expect(whole.pixels.greenBefore).toEqual([0, 255, 0]);
+            expect(whole.pixels.greenAfter).toEqual([0, 255, 0]);
+            expect(whole.pixels.blue).toEqual([0, 0, 255]);
+            Object.keys(parts.left).forEach(function (name) {
+                expect(left.pixels[name]).toEqual(whole.pixels[name]);
+            });
+            Object.keys(parts.right).forEach(function (name) {
+                expect(right.pixels[name]).toEqual(whole.pixels[name]);
+            });
+            Object.keys(decoders).forEach(function (name) {
+                decoders[name].close();
+            });
+        });
+    });
 });
 
 describe("WebPage construction with options", function () {
@@ -1365,3 +2043,34 @@ describe("WebPage closing notification/alerting: closing propagation control", f
         });
     });
 });
+
+describe("WebPage pool", function(){
+    it("should hand out recycled pages in a clean state", function() {
+        var webpage = require('webpage');
+        var page = webpage.acquire();
+        var alerts = 0;
+
+        page.viewportSize = { width: 1024, height: 768 };
+        page.customHeaders = { "X-Job": "1" };
+        page.content = "<html><body>used</body></html>";
+        page.onAlert = function() { ++alerts; };
+
+        expect(page.recycle()).toBeTruthy();
+
+        page = webpage.acquire();
+        expect(page.viewportSize).toEqual({ width: 400, height: 300 });
+        expect(page.customHeaders).toEqual({});
+        expect(page.plainText).toEqual("");
+        page.evaluate(function() { alert("not for the old handler"); });
+        expect(alerts).toEqual(0);
+        page.close();
+    });
+
+    it("should close recycled pages once the pool is full", function() {
+        var webpage = require('webpage');
+        var size = phantom.pagePoolSize;
+        phantom.pagePoolSize = 0;
+        expect(webpage.acquire().recycle()).toBeFalsy();
+        phantom.pagePoolSize = size;
+    });
+});
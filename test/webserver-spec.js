@@ -157,3 +157,109 @@ describe("WebServer object", function() {
         });
     });
 });
+
+describe("WebServer streaming", function() {
+    var server = require('webserver').create();
+
+    it("should stream request bodies and send chunked responses", function() {
+        var page = require('webpage').create();
+        var url = "http://localhost:12346/upload";
+        var received = "";
+        var handled = false;
+        runs(function() {
+            expect(server.listen(12346, { numThreads: 2, streamRequestBody: true }, function (request, response) {
+                expect(request.hasOwnProperty('post')).toBeFalsy();
+                response.requestData.connect(function (chunk) {
+                    received += chunk;
+                });
+                response.requestEnd.connect(function () {
+                    response.writeHead(200, { "Transfer-Encoding": "chunked" });
+                    response.setEncoding("binary");
+                    response.write("streamed ");
+                    response.write(received);
+                    response.close();
+                });
+            })).toEqual(true);
+            page.open(url, 'post', "universe=expanding", function (status) {
+                expect(status == 'success').toEqual(true);
+                expect(page.plainText).toEqual("streamed universe=expanding");
+                handled = true;
+            });
+        });
+
+        waitsFor(function () {
+            return handled;
+        }, "the streamed response to arrive", 3000);
+
+        runs(function() {
+            expect(received).toEqual("universe=expanding");
+            expect(handled).toEqual(true);
+            server.close();
+        });
+    });
+
+    it("should send a response written while the body is still streaming", function() {
+        var page = require('webpage').create();
+        var url = "http://localhost:12346/early";
+        var body = new Array(20001).join("x");
+        var chunks = 0;
+        var handled = false;
+        runs(function() {
+            expect(server.listen(12346, { streamRequestBody: true }, function (request, response) {
+                response.requestData.connect(function (chunk) {
+                    if (chunks++ === 0) {
+                        response.writeHead(200, { "Transfer-Encoding": "chunked" });
+                        response.write("early ");
+                    }
+                });
+                response.requestEnd.connect(function () {
+                    response.write("done");
+                    response.close();
+                });
+            })).toEqual(true);
+            page.open(url, 'post', body, function (status) {
+                expect(status == 'success').toEqual(true);
+                expect(page.plainText).toEqual("early done");
+                handled = true;
+            });
+        });
+
+        waitsFor(function () {
+            return handled;
+        }, "the response to arrive", 3000);
+
+        runs(function() {
+            expect(chunks).toBeGreaterThan(1);
+            server.close();
+        });
+    });
+
+    it("should close a response the script never closes after responseTimeout", function() {
+        var page = require('webpage').create();
+        var url = "http://localhost:12346/forgotten";
+        var status = null;
+        var handled = false;
+        runs(function() {
+            expect(server.listen(12346, { responseTimeout: 200 }, function (request, response) {
+                // never closed
+            })).toEqual(true);
+            page.onResourceReceived = function (resource) {
+                if (resource.url === url && resource.stage === "end") {
+                    status = resource.status;
+                }
+            };
+            page.open(url, function () {
+                handled = true;
+            });
+        });
+
+        waitsFor(function () {
+            return handled;
+        }, "the timed out response", 3000);
+
+        runs(function() {
+            expect(status).toEqual(504);
+            server.close();
+        });
+    });
+});
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# Measures PhantomJS startup, phase by phase, averaged over several runs.
+#
+# Usage: startup-benchmark.sh [runs] [phantomjs options...]
+# e.g.   startup-benchmark.sh 20 --config=config.json
+#
+# Set PHANTOMJS to benchmark a binary other than ../bin/phantomjs.
+
+RUNS=${1:-10}
+shift
+
+PHANTOMJS=${PHANTOMJS:-`dirname $0`/../bin/phantomjs}
+SCRIPT=`mktemp /tmp/startup-benchmark-XXXXXX.js`
+trap "rm -f $SCRIPT" EXIT
+
+cat > $SCRIPT <<'JS'
+var timings = phantom.startupTimings;
+for (var phase in timings) {
+    console.log(phase + ' ' + timings[phase]);
+}
+phantom.exit();
+JS
+
+for i in `seq 1 $RUNS`; do
+    "$PHANTOMJS" "$@" $SCRIPT
+done | awk -v runs=$RUNS '
+    !($1 in sum) { order[n++] = $1 }
+    { sum[$1] += $2 }
+    END {
+        printf "%-12s %10s\n", "phase", "avg (ms)"
+        for (i = 0; i < n; i++) {
+            printf "%-12s %10.3f\n", order[i], sum[order[i]] / runs
+        }
+    }'